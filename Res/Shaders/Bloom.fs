@@ -5,30 +5,21 @@ in vec2 fragTexCoord;
 in vec4 fragColor;
 
 // Input uniform values
-uniform sampler2D texture0;
+uniform sampler2D texture0;     // Scene
+uniform sampler2D bloomHalf;    // Blurred emission, half resolution
+uniform sampler2D bloomQuarter; // Blurred emission, quarter resolution
 uniform vec4 colDiffuse;
+uniform float intensity;
 
 // Output fragment color
 out vec4 finalColor;
 
-const vec2 size = vec2(1200, 650);  // Framebuffer size
-const float samples = 6.5;          // Pixels per axis; higher = bigger glow, worse performance
-const float quality = 4.5;          // Defines size factor: Lower = smaller glow, better quality
-
 void main()
 {
-    vec4 sum = vec4(0);
-    vec2 sizeFactor = vec2(1)/size*quality;
-
-    // Texel color fetching from texture sampler
     vec4 source = texture(texture0, fragTexCoord);
 
-    const int range = 2;            // should be = (samples - 1)/2;
-
-    for (int x = -range; x <= range; x++)
-        for (int y = -range; y <= range; y++)
-            sum += texture(texture0, fragTexCoord + vec2(x, y)*sizeFactor);
+    // The quarter level widens the glow at no extra taps
+    vec3 bloom = texture(bloomHalf, fragTexCoord).rgb + texture(bloomQuarter, fragTexCoord).rgb;
 
-    // Calculate final fragment color
-    finalColor = ((sum/(samples*samples)) + source)*colDiffuse;
-}
\ No newline at end of file
+    finalColor = vec4(source.rgb + bloom*intensity, source.a)*colDiffuse;
+}
@@ -0,0 +1,29 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec2 direction;         // One texel along the blur axis
+
+// Output fragment color
+out vec4 finalColor;
+
+// 9-tap gaussian folded into 5 bilinear fetches
+const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main()
+{
+    vec3 sum = texture(texture0, fragTexCoord).rgb*weights[0];
+
+    for (int i = 1; i < 3; i++)
+    {
+        sum += texture(texture0, fragTexCoord + direction*offsets[i]).rgb*weights[i];
+        sum += texture(texture0, fragTexCoord - direction*offsets[i]).rgb*weights[i];
+    }
+
+    finalColor = vec4(sum, 1.0);
+}
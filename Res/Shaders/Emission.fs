@@ -0,0 +1,25 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D emissionMap;
+uniform vec4 colDiffuse;
+uniform float threshold;        // Emission under this brightness doesn't glow
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    vec3 emission = texture(emissionMap, fragTexCoord).rgb;
+
+    // Soft bright pass, keeping the hue
+    float brightness = max(emission.r, max(emission.g, emission.b));
+    emission *= max(brightness - threshold, 0.0)/max(brightness, 0.0001);
+
+    // The model's fade dims the glow as well
+    finalColor = vec4(emission*colDiffuse.a, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;     // Distance field atlas
+uniform vec4 colDiffuse;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Signed distance to the glyph outline, 0.5 being on it
+    float distance = texture(texture0, fragTexCoord).r - 0.5;
+
+    // Antialiasing over one screen pixel, whatever the text size
+    // (kept above 0 where the distance is flat, smoothstep being
+    // undefined for equal edges)
+    float width = max(length(vec2(dFdx(distance), dFdy(distance))), 1e-4);
+    float alpha = smoothstep(-width, width, distance);
+
+    finalColor = vec4(fragColor.rgb, fragColor.a*alpha)*colDiffuse;
+}
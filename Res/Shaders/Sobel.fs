@@ -2,39 +2,39 @@
 
 // Input vertex attributes (from vertex shader)
 in vec2 fragTexCoord;
-in vec4 fragColor;
+in vec4 fragColor;              // Outline color
 
 // Input uniform values
-uniform sampler2D texture0;
-uniform vec4 colDiffuse;
+uniform sampler2D texture0;     // Scene depth
+uniform vec2 resolution;        // Scene size in pixels
 
 // Output fragment color
 out vec4 finalColor;
 
-uniform vec2 resolution = vec2(1200, 650);
+// 1 where geometry was drawn, 0 on the cleared background
+float coverage(float x, float y)
+{
+    return texture(texture0, fragTexCoord + vec2(x, y)/resolution).r < 1.0 ? 1.0 : 0.0;
+}
 
 void main()
 {
-    float x = 1.0/resolution.x;
-    float y = 1.0/resolution.y;
-
-    vec4 horizEdge = vec4(0.0);
-    horizEdge -= texture2D(texture0, vec2(fragTexCoord.x - x, fragTexCoord.y - y))*1.0;
-    horizEdge -= texture2D(texture0, vec2(fragTexCoord.x - x, fragTexCoord.y    ))*2.0;
-    horizEdge -= texture2D(texture0, vec2(fragTexCoord.x - x, fragTexCoord.y + y))*1.0;
-    horizEdge += texture2D(texture0, vec2(fragTexCoord.x + x, fragTexCoord.y - y))*1.0;
-    horizEdge += texture2D(texture0, vec2(fragTexCoord.x + x, fragTexCoord.y    ))*2.0;
-    horizEdge += texture2D(texture0, vec2(fragTexCoord.x + x, fragTexCoord.y + y))*1.0;
-
-    vec4 vertEdge = vec4(0.0);
-    vertEdge -= texture2D(texture0, vec2(fragTexCoord.x - x, fragTexCoord.y - y))*1.0;
-    vertEdge -= texture2D(texture0, vec2(fragTexCoord.x    , fragTexCoord.y - y))*2.0;
-    vertEdge -= texture2D(texture0, vec2(fragTexCoord.x + x, fragTexCoord.y - y))*1.0;
-    vertEdge += texture2D(texture0, vec2(fragTexCoord.x - x, fragTexCoord.y + y))*1.0;
-    vertEdge += texture2D(texture0, vec2(fragTexCoord.x    , fragTexCoord.y + y))*2.0;
-    vertEdge += texture2D(texture0, vec2(fragTexCoord.x + x, fragTexCoord.y + y))*1.0;
-
-    vec3 edge = sqrt((horizEdge.rgb*horizEdge.rgb) + (vertEdge.rgb*vertEdge.rgb));
-
-    finalColor = vec4(edge, texture2D(texture0, fragTexCoord).a);
-}
\ No newline at end of file
+    // The 8 neighbours, each one shared by both kernels
+    float topLeft = coverage(-1.0, -1.0);
+    float top = coverage(0.0, -1.0);
+    float topRight = coverage(1.0, -1.0);
+    float left = coverage(-1.0, 0.0);
+    float right = coverage(1.0, 0.0);
+    float bottomLeft = coverage(-1.0, 1.0);
+    float bottom = coverage(0.0, 1.0);
+    float bottomRight = coverage(1.0, 1.0);
+
+    float horizEdge = (topRight + 2.0*right + bottomRight) - (topLeft + 2.0*left + bottomLeft);
+    float vertEdge = (bottomLeft + 2.0*bottom + bottomRight) - (topLeft + 2.0*top + topRight);
+
+    float edge = min(sqrt(horizEdge*horizEdge + vertEdge*vertEdge), 1.0);
+
+    if (edge <= 0.0) discard;
+
+    finalColor = vec4(fragColor.rgb, fragColor.a*edge);
+}
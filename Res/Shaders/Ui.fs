@@ -0,0 +1,28 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;     // Font distance field atlas
+uniform vec4 colDiffuse;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Glyphs are cut from the distance field, 0.5 being on the outline
+    // (computed for shapes too, derivatives need uniform control flow).
+    // The width stays above 0 where the distance is flat (saturated
+    // interiors, the white texel), smoothstep being undefined there
+    float distance = texture(texture0, fragTexCoord).r - 0.5;
+    float width = max(length(vec2(dFdx(distance), dFdy(distance))), 1e-4);
+    float coverage = smoothstep(-width, width, distance);
+
+    // Shapes have negative texture coordinates and are fully covered
+    if (fragTexCoord.x < 0.0) coverage = 1.0;
+
+    finalColor = vec4(fragColor.rgb, fragColor.a*coverage)*colDiffuse;
+}
@@ -0,0 +1,32 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec3 fragBarycentric;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;        // Solid tint, its alpha fades the model
+uniform vec4 wireColor;         // Edge color, its alpha fades the wireframe
+uniform float wireWidth;        // Edge width in pixels
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    vec4 solid = texture(texture0, fragTexCoord)*colDiffuse;
+
+    // Distance to the closest edge, in pixels
+    vec3 width = max(fwidth(fragBarycentric)*wireWidth, vec3(1e-4));
+    vec3 coverage = smoothstep(vec3(0.0), width, fragBarycentric);
+    float edge = 1.0 - min(min(coverage.x, coverage.y), coverage.z);
+
+    // Wire blended over the solid, both over the framebuffer
+    float wire = wireColor.a*edge;
+    float alpha = wire + solid.a*(1.0 - wire);
+
+    if (alpha <= 0.0) discard;
+
+    finalColor = vec4((wireColor.rgb*wire + solid.rgb*solid.a*(1.0 - wire))/alpha, alpha);
+}
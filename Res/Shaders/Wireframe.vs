@@ -0,0 +1,21 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;            // Barycentric coordinates of the corner
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec3 fragBarycentric;
+
+void main()
+{
+    fragTexCoord = vertexTexCoord;
+    fragBarycentric = vertexColor.rgb;
+
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,140 @@
+#include "Bench.h"
+#include "SoftFrame.h"
+
+// zooms in and out on every weapon, cycled until the frames run out
+bench_step_t const BENCH_SCRIPT[] = {
+    {.input = {.zoom_in = true}, .frames = 150},
+    {.input = {0}, .frames = 30},
+    {.input = {.zoom_out = true}, .frames = 150},
+    {.input = {.switch_next_weapon = true}, .frames = 1},
+    {.input = {0}, .frames = 60},
+    {.input = {.zoom_in = true}, .frames = 80},
+    {.input = {.switch_next_weapon = true}, .frames = 1},
+    {.input = {.zoom_out = true}, .frames = 80},
+    {.input = {.switch_previous_weapon = true}, .frames = 1},
+    {.input = {.switch_previous_weapon = true}, .frames = 1},
+    {.input = {0}, .frames = 60},
+};
+
+#define BENCH_SCRIPT_LENGTH \
+    ((int)(sizeof(BENCH_SCRIPT) / sizeof(BENCH_SCRIPT[0])))
+
+// input of the script at the given frame
+input_t bench_script_input(int frame) {
+    int script_frames = 0;
+    for (int i = 0; i < BENCH_SCRIPT_LENGTH; i++)
+        script_frames += BENCH_SCRIPT[i].frames;
+
+    frame %= script_frames;
+
+    for (int i = 0; i < BENCH_SCRIPT_LENGTH; i++) {
+        if (frame < BENCH_SCRIPT[i].frames)
+            return BENCH_SCRIPT[i].input;
+
+        frame -= BENCH_SCRIPT[i].frames;
+    }
+
+    return (input_t){0};
+}
+
+// a frame drawn by gl, or by the soft frame when given
+void bench_frame(ctx_t* ctx, soft_frame_t* soft) {
+    if (soft != NULL)
+        soft_ctx_internal_update(ctx, soft);
+    else
+        ctx_internal_update(ctx);
+}
+
+int compare_doubles(void const* a, void const* b) {
+    double const x = *(double const*)a;
+    double const y = *(double const*)b;
+    return (x > y) - (x < y);
+}
+
+// sorts the samples in place and prints their statistics in ms
+void bench_print_phase(char const* name, double* samples, int count) {
+    qsort(samples, count, sizeof(double), compare_doubles);
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += samples[i];
+
+    printf("%-10s %10.3f %10.3f %10.3f %10.3f %10.3f\n", name,
+           samples[0] * 1000, samples[count / 2] * 1000,
+           samples[(int)(count * 0.99)] * 1000, samples[count - 1] * 1000,
+           sum / count * 1000);
+}
+
+int run_bench(int frames, bool is_soft) {
+    if (frames <= 0)
+        frames = BENCH_DEFAULT_FRAMES;
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    // the soft frames need neither a window nor gl
+    ctx_t ctx;
+    if (is_soft) {
+        init_ctx_cpu(&ctx);
+    } else {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(SCREEN_W, SCREEN_H, TITLE);
+        init_ctx(&ctx);
+    }
+    ctx.is_input_scripted = true;
+    // every frame pays for the whole 3d pass
+    ctx.render_on_demand = false;
+
+    soft_frame_t soft = {0};
+    if (is_soft)
+        init_soft_frame(&soft, &ctx, ctx_screen_width(),
+                        ctx_screen_height(), 0);
+
+    for (int i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+        ctx.input = (input_t){0};
+        bench_frame(&ctx, is_soft ? &soft : NULL);
+    }
+
+    // one sample array per phase, plus the whole frame
+    double* const samples = malloc(sizeof(double) * frames * 5);
+    double* const update = samples;
+    double* const draw_3d = samples + frames;
+    double* const ui = samples + frames * 2;
+    double* const present = samples + frames * 3;
+    double* const total = samples + frames * 4;
+    // the soft frames don't cull, their counters stay 0
+    int64_t drawn_triangles = 0;
+    int64_t culled_triangles = 0;
+
+    for (int i = 0; i < frames; i++) {
+        ctx.input = bench_script_input(i);
+        bench_frame(&ctx, is_soft ? &soft : NULL);
+
+        update[i] = ctx.timings.update;
+        draw_3d[i] = ctx.timings.draw_3d;
+        ui[i] = ctx.timings.ui;
+        present[i] = ctx.timings.present;
+        total[i] = update[i] + draw_3d[i] + ui[i] + present[i];
+        drawn_triangles += ctx.cull_stats.drawn_triangles;
+        culled_triangles += ctx.cull_stats.culled_triangles;
+    }
+
+    printf("%d %s frames, times in ms\n", frames, is_soft ? "soft" : "gl");
+    printf("%-10s %10s %10s %10s %10s %10s\n", "phase", "min", "median",
+           "p99", "max", "mean");
+    bench_print_phase("update", update, frames);
+    bench_print_phase("draw_3d", draw_3d, frames);
+    bench_print_phase("ui", ui, frames);
+    bench_print_phase("present", present, frames);
+    bench_print_phase("frame", total, frames);
+    printf("triangles per frame: %lld drawn, %lld culled\n",
+           (long long)(drawn_triangles / frames),
+           (long long)(culled_triangles / frames));
+
+    free(samples);
+    if (is_soft)
+        deinit_soft_frame(&soft);
+    deinit_ctx(&ctx);
+    if (!is_soft)
+        CloseWindow();
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef SOURCE_BENCH_C
+#define SOURCE_BENCH_C
+
+#include "Context.h"
+
+#define BENCH_DEFAULT_FRAMES ((int)2000)
+// frames run before measuring, so that streaming and
+// driver warm-up don't end up in the statistics
+#define BENCH_WARMUP_FRAMES ((int)60)
+
+// one step of the scripted input, held for a number of frames
+typedef struct {
+    input_t input;
+    int frames;
+} bench_step_t;
+
+// runs the frame loop for the given number of frames in a hidden window,
+// feeding the scripted input, then prints the per-phase statistics.
+// soft frames are drawn by the cpu rasterizer (soft_frame_t) from
+// a cpu only ctx (init_ctx_cpu), without any window nor gl
+int run_bench(int frames, bool is_soft);
+
+#endif
@@ -0,0 +1,623 @@
+#include "Bvh.h"
+#include "Profiler.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+// a ray set up for the slab tests
+typedef struct {
+    Vector3 origin;
+    Vector3 direction;
+#if defined(__SSE2__)
+    __m128 origin4;
+    __m128 inv_direction4;
+    // keeps x, y and z, the 4th lane of a node bound is an int
+    __m128 xyz_mask;
+#else
+    Vector3 inv_direction;
+#endif
+} bvh_ray_t;
+
+// a centroid bin of the sah sweep
+typedef struct {
+    BoundingBox bounds;
+    int count;
+} bvh_bin_t;
+
+// the state of a mesh being built
+typedef struct {
+    mesh_bvh_t* bvh;
+    // per mesh triangle
+    BoundingBox* boxes;
+    Vector3* centroids;
+    // triangles partitioned in place, in leaf order once built
+    int* order;
+} bvh_builder_t;
+
+BoundingBox bvh_empty_box() {
+    return (BoundingBox){.min = scalar_to_vec3(INFINITY),
+                         .max = scalar_to_vec3(-INFINITY)};
+}
+
+BoundingBox bvh_box_grow(BoundingBox a, BoundingBox b) {
+    return (BoundingBox){.min = Vector3Min(a.min, b.min),
+                         .max = Vector3Max(a.max, b.max)};
+}
+
+// half the surface, the sah only compares ratios
+float bvh_box_half_area(BoundingBox box) {
+    Vector3 const e = Vector3Subtract(box.max, box.min);
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+float vec3_axis(Vector3 v, int axis) {
+    return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+int bvh_bin_index(float centroid, float lo, float extent) {
+    int const bin = (int)((centroid - lo) / extent * BVH_SAH_BINS);
+    return bin < BVH_SAH_BINS ? bin : BVH_SAH_BINS - 1;
+}
+
+void bvh_make_leaf(bvh_node_t* node, int first, int count) {
+    node->offset = first;
+    node->count = count;
+}
+
+// the cheapest split of the triangles by the surface area heuristic,
+// false when none is cheaper than a leaf
+bool bvh_find_split(bvh_builder_t const* b, int first, int count,
+                    BoundingBox bounds, BoundingBox centroid_bounds,
+                    int* split_axis, int* split_bin) {
+    float const leaf_cost = (float)count;
+    float const node_area = bvh_box_half_area(bounds);
+    float best_cost = INFINITY;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float const lo = vec3_axis(centroid_bounds.min, axis);
+        float const extent = vec3_axis(centroid_bounds.max, axis) - lo;
+
+        if (extent <= 0)
+            continue;
+
+        bvh_bin_t bins[BVH_SAH_BINS];
+        for (int i = 0; i < BVH_SAH_BINS; i++)
+            bins[i] = (bvh_bin_t){.bounds = bvh_empty_box()};
+
+        for (int i = first; i < first + count; i++) {
+            int const t = b->order[i];
+            bvh_bin_t* const bin = &bins[bvh_bin_index(
+                vec3_axis(b->centroids[t], axis), lo, extent)];
+
+            bin->bounds = bvh_box_grow(bin->bounds, b->boxes[t]);
+            bin->count++;
+        }
+
+        // costs of the left sides swept forward,
+        // then added to the right sides swept back
+        float costs[BVH_SAH_BINS - 1];
+        BoundingBox left = bvh_empty_box();
+        int left_count = 0;
+
+        for (int i = 0; i < BVH_SAH_BINS - 1; i++) {
+            left = bvh_box_grow(left, bins[i].bounds);
+            left_count += bins[i].count;
+            costs[i] =
+                left_count > 0 ? bvh_box_half_area(left) * left_count : 0;
+        }
+
+        BoundingBox right = bvh_empty_box();
+        int right_count = 0;
+
+        for (int i = BVH_SAH_BINS - 1; i > 0; i--) {
+            right = bvh_box_grow(right, bins[i].bounds);
+            right_count += bins[i].count;
+
+            if (right_count == 0 || right_count == count)
+                continue;
+
+            float const cost =
+                BVH_TRAVERSAL_COST +
+                (costs[i - 1] + bvh_box_half_area(right) * right_count) /
+                    node_area;
+
+            if (cost < best_cost) {
+                best_cost = cost;
+                *split_axis = axis;
+                *split_bin = i;
+            }
+        }
+    }
+
+    return best_cost < leaf_cost;
+}
+
+void bvh_build_node(bvh_builder_t* b, int node_index, int first, int count,
+                    int depth) {
+    BoundingBox bounds = bvh_empty_box();
+    BoundingBox centroid_bounds = bvh_empty_box();
+
+    for (int i = first; i < first + count; i++) {
+        int const t = b->order[i];
+        bounds = bvh_box_grow(bounds, b->boxes[t]);
+        centroid_bounds = bvh_box_grow(
+            centroid_bounds,
+            (BoundingBox){.min = b->centroids[t], .max = b->centroids[t]});
+    }
+
+    bvh_node_t* const node = &b->bvh->nodes[node_index];
+    node->min = bounds.min;
+    node->max = bounds.max;
+
+    int split_axis = -1;
+    int split_bin = 0;
+
+    // a leaf past the depth the traversal stacks can take, or
+    // when splitting costs more (as long as the leaf stays small)
+    if (count <= BVH_MAX_LEAF_TRIANGLES || depth >= BVH_MAX_DEPTH - 1 ||
+        (!bvh_find_split(b, first, count, bounds, centroid_bounds,
+                         &split_axis, &split_bin) &&
+         count <= BVH_MAX_LEAF_TRIANGLES * 4)) {
+        bvh_make_leaf(node, first, count);
+        return;
+    }
+
+    int mid = first;
+
+    if (split_axis >= 0) {
+        float const lo = vec3_axis(centroid_bounds.min, split_axis);
+        float const extent = vec3_axis(centroid_bounds.max, split_axis) - lo;
+
+        for (int i = first; i < first + count; i++) {
+            int const t = b->order[i];
+
+            if (bvh_bin_index(vec3_axis(b->centroids[t], split_axis), lo,
+                              extent) < split_bin) {
+                b->order[i] = b->order[mid];
+                b->order[mid++] = t;
+            }
+        }
+    }
+
+    // every centroid in the same place, halved as they come
+    if (mid == first || mid == first + count)
+        mid = first + count / 2;
+
+    // depth first, the first child right after its parent
+    int const left = b->bvh->node_count++;
+    bvh_build_node(b, left, first, mid - first, depth + 1);
+
+    int const right = b->bvh->node_count++;
+    b->bvh->nodes[node_index].offset = right;
+    b->bvh->nodes[node_index].count = 0;
+    bvh_build_node(b, right, mid, first + count - mid, depth + 1);
+}
+
+Vector3 bvh_mesh_corner(Mesh const* mesh, int corner) {
+    int const v = mesh->indices != NULL ? mesh->indices[corner] : corner;
+    return vec3(mesh->vertices[v * 3], mesh->vertices[v * 3 + 1],
+                mesh->vertices[v * 3 + 2]);
+}
+
+mesh_bvh_t build_mesh_bvh(Mesh const* mesh) {
+    int const count = mesh->vertices != NULL ? mesh->triangleCount : 0;
+    mesh_bvh_t bvh = {0};
+
+    if (count <= 0)
+        return bvh;
+
+    bvh_builder_t b = {.bvh = &bvh,
+                       .boxes = malloc(sizeof(BoundingBox) * count),
+                       .centroids = malloc(sizeof(Vector3) * count),
+                       .order = malloc(sizeof(int) * count)};
+
+    for (int t = 0; t < count; t++) {
+        Vector3 const a = bvh_mesh_corner(mesh, t * 3);
+        Vector3 const c1 = bvh_mesh_corner(mesh, t * 3 + 1);
+        Vector3 const c2 = bvh_mesh_corner(mesh, t * 3 + 2);
+
+        b.boxes[t] = (BoundingBox){.min = Vector3Min(a, Vector3Min(c1, c2)),
+                                   .max = Vector3Max(a, Vector3Max(c1, c2))};
+        b.centroids[t] =
+            Vector3Scale(Vector3Add(b.boxes[t].min, b.boxes[t].max), 0.5f);
+        b.order[t] = t;
+    }
+
+    // a binary tree with single triangle leaves at most
+    bvh.nodes = malloc(sizeof(bvh_node_t) * (count * 2 - 1));
+    bvh.node_count = 1;
+    bvh_build_node(&b, 0, 0, count, 0);
+    bvh.nodes = realloc(bvh.nodes, sizeof(bvh_node_t) * bvh.node_count);
+
+    // the triangles in leaf order, read sequentially by the leaves
+    bvh.triangles = malloc(sizeof(Vector3) * 3 * count);
+    for (int i = 0; i < count; i++) {
+        int const t = b.order[i];
+        Vector3 const a = bvh_mesh_corner(mesh, t * 3);
+
+        bvh.triangles[i * 3] = a;
+        bvh.triangles[i * 3 + 1] =
+            Vector3Subtract(bvh_mesh_corner(mesh, t * 3 + 1), a);
+        bvh.triangles[i * 3 + 2] =
+            Vector3Subtract(bvh_mesh_corner(mesh, t * 3 + 2), a);
+    }
+
+    bvh.triangle_indices = b.order;
+    bvh.triangle_count = count;
+
+    free(b.boxes);
+    free(b.centroids);
+
+    return bvh;
+}
+
+model_bvh_t build_model_bvh(Model const* model) {
+    PROFILE_ZONE("build_model_bvh");
+
+    model_bvh_t bvh = {.mesh_count = model->meshCount};
+    if (model->meshCount <= 0)
+        return bvh;
+
+    bvh.meshes = malloc(sizeof(mesh_bvh_t) * model->meshCount);
+    for (int i = 0; i < model->meshCount; i++)
+        bvh.meshes[i] = build_mesh_bvh(&model->meshes[i]);
+
+    // the same sah build over the roots of the meshes,
+    // the meshes without triangles are left out
+    int count = 0;
+    bvh_builder_t b = {.boxes = malloc(sizeof(BoundingBox) * model->meshCount),
+                       .centroids = malloc(sizeof(Vector3) * model->meshCount),
+                       .order = malloc(sizeof(int) * model->meshCount)};
+
+    for (int i = 0; i < model->meshCount; i++) {
+        if (bvh.meshes[i].node_count == 0)
+            continue;
+
+        bvh_node_t const* const root = &bvh.meshes[i].nodes[0];
+        b.boxes[i] = (BoundingBox){.min = root->min, .max = root->max};
+        b.centroids[i] = Vector3Scale(Vector3Add(root->min, root->max), 0.5f);
+        b.order[count++] = i;
+    }
+
+    if (count > 0) {
+        mesh_bvh_t top = {.nodes = malloc(sizeof(bvh_node_t) * (count * 2 - 1)),
+                          .node_count = 1};
+        b.bvh = &top;
+        bvh_build_node(&b, 0, 0, count, 0);
+
+        bvh.nodes = realloc(top.nodes, sizeof(bvh_node_t) * top.node_count);
+        bvh.node_count = top.node_count;
+    }
+
+    bvh.mesh_order = b.order;
+
+    free(b.boxes);
+    free(b.centroids);
+
+    return bvh;
+}
+
+void unload_model_bvh(model_bvh_t* bvh) {
+    for (int i = 0; i < bvh->mesh_count; i++) {
+        free(bvh->meshes[i].nodes);
+        free(bvh->meshes[i].triangles);
+        free(bvh->meshes[i].triangle_indices);
+    }
+
+    free(bvh->meshes);
+    free(bvh->nodes);
+    free(bvh->mesh_order);
+    *bvh = (model_bvh_t){0};
+}
+
+size_t model_bvh_memory_size(model_bvh_t const* bvh) {
+    size_t size = sizeof(bvh_node_t) * bvh->node_count +
+                  sizeof(int) * bvh->mesh_count;
+
+    for (int i = 0; i < bvh->mesh_count; i++)
+        size += sizeof(bvh_node_t) * bvh->meshes[i].node_count +
+                (sizeof(Vector3) * 3 + sizeof(int)) *
+                    bvh->meshes[i].triangle_count;
+
+    return size;
+}
+
+bvh_ray_t bvh_setup_ray(Ray ray) {
+    // divisions by 0 give infinities, the slabs
+    // parallel to the ray are then never crossed
+    Vector3 const inv = vec3(1 / ray.direction.x, 1 / ray.direction.y,
+                             1 / ray.direction.z);
+    bvh_ray_t r = {.origin = ray.position, .direction = ray.direction};
+
+#if defined(__SSE2__)
+    r.origin4 = _mm_setr_ps(ray.position.x, ray.position.y, ray.position.z, 0);
+    r.inv_direction4 = _mm_setr_ps(inv.x, inv.y, inv.z, 0);
+    r.xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+#else
+    r.inv_direction = inv;
+#endif
+
+    return r;
+}
+
+// distance at which the ray enters the node's box,
+// INFINITY when it misses it or enters past max_distance
+float bvh_ray_box(bvh_ray_t const* ray, bvh_node_t const* node,
+                  float max_distance) {
+#if defined(__SSE2__)
+    // the three slabs at once
+    __m128 const min4 = _mm_and_ps(_mm_loadu_ps(&node->min.x), ray->xyz_mask);
+    __m128 const max4 = _mm_and_ps(_mm_loadu_ps(&node->max.x), ray->xyz_mask);
+    __m128 const t0 =
+        _mm_mul_ps(_mm_sub_ps(min4, ray->origin4), ray->inv_direction4);
+    __m128 const t1 =
+        _mm_mul_ps(_mm_sub_ps(max4, ray->origin4), ray->inv_direction4);
+    __m128 const near4 = _mm_min_ps(t0, t1);
+    __m128 const far4 = _mm_max_ps(t0, t1);
+
+    // latest entry and earliest exit over x, y and z
+    __m128 enter = _mm_max_ss(near4, _mm_shuffle_ps(near4, near4, 1));
+    enter = _mm_max_ss(enter, _mm_shuffle_ps(near4, near4, 2));
+    enter = _mm_max_ss(enter, _mm_setzero_ps());
+
+    __m128 exit = _mm_min_ss(far4, _mm_shuffle_ps(far4, far4, 1));
+    exit = _mm_min_ss(exit, _mm_shuffle_ps(far4, far4, 2));
+    exit = _mm_min_ss(exit, _mm_set_ss(max_distance));
+
+    return _mm_comile_ss(enter, exit) ? _mm_cvtss_f32(enter) : INFINITY;
+#else
+    float const tx0 = (node->min.x - ray->origin.x) * ray->inv_direction.x;
+    float const tx1 = (node->max.x - ray->origin.x) * ray->inv_direction.x;
+    float const ty0 = (node->min.y - ray->origin.y) * ray->inv_direction.y;
+    float const ty1 = (node->max.y - ray->origin.y) * ray->inv_direction.y;
+    float const tz0 = (node->min.z - ray->origin.z) * ray->inv_direction.z;
+    float const tz1 = (node->max.z - ray->origin.z) * ray->inv_direction.z;
+
+    float const enter =
+        fmaxf(fmaxf(fminf(tx0, tx1), fminf(ty0, ty1)),
+              fmaxf(fminf(tz0, tz1), 0));
+    float const exit =
+        fminf(fminf(fmaxf(tx0, tx1), fmaxf(ty0, ty1)),
+              fminf(fmaxf(tz0, tz1), max_distance));
+
+    return enter <= exit ? enter : INFINITY;
+#endif
+}
+
+// distance of the ray to the triangle (moller-trumbore, both
+// faces), INFINITY when it misses it
+float bvh_ray_triangle(bvh_ray_t const* ray, Vector3 const* triangle) {
+    Vector3 const e1 = triangle[1];
+    Vector3 const e2 = triangle[2];
+    Vector3 const p = Vector3CrossProduct(ray->direction, e2);
+    float const det = Vector3DotProduct(e1, p);
+
+    if (det == 0)
+        return INFINITY;
+
+    float const inv_det = 1 / det;
+    Vector3 const s = Vector3Subtract(ray->origin, triangle[0]);
+    float const u = Vector3DotProduct(s, p) * inv_det;
+
+    if (u < 0 || u > 1)
+        return INFINITY;
+
+    Vector3 const q = Vector3CrossProduct(s, e1);
+    float const v = Vector3DotProduct(ray->direction, q) * inv_det;
+
+    if (v < 0 || u + v > 1)
+        return INFINITY;
+
+    float const t = Vector3DotProduct(e2, q) * inv_det;
+    return t > 0 ? t : INFINITY;
+}
+
+// the child of an inner node to visit next, the nearer one, stacking
+// the farther one (which may get skipped once a closer hit is known).
+// -1 when the ray misses both
+int bvh_descend(bvh_node_t const* nodes, bvh_node_t const* node,
+                int node_index, bvh_ray_t const* ray, float max_distance,
+                int* stack, int* stack_size) {
+    int near = node_index + 1;
+    int far = node->offset;
+    float t_near = bvh_ray_box(ray, &nodes[near], max_distance);
+    float t_far = bvh_ray_box(ray, &nodes[far], max_distance);
+
+    if (t_far < t_near) {
+        int const n = near;
+        float const t = t_near;
+        near = far;
+        t_near = t_far;
+        far = n;
+        t_far = t;
+    }
+
+    if (t_near == INFINITY)
+        return -1;
+
+    if (t_far != INFINITY)
+        stack[(*stack_size)++] = far;
+
+    return near;
+}
+
+// the closest triangle (leaf order) under max_distance, -1 for none.
+// with any_hit set, the first one found
+int bvh_traverse(mesh_bvh_t const* bvh, bvh_ray_t const* ray,
+                 float max_distance, bool any_hit, float* distance) {
+    if (bvh->node_count == 0 ||
+        bvh_ray_box(ray, &bvh->nodes[0], max_distance) == INFINITY)
+        return -1;
+
+    int stack[BVH_MAX_DEPTH];
+    int stack_size = 0;
+    int node_index = 0;
+    int closest = -1;
+    float closest_distance = max_distance;
+
+    for (;;) {
+        bvh_node_t const* const node = &bvh->nodes[node_index];
+
+        if (node->count > 0) {
+            for (int i = node->offset; i < node->offset + node->count; i++) {
+                float const t = bvh_ray_triangle(ray, &bvh->triangles[i * 3]);
+
+                if (t < closest_distance) {
+                    closest_distance = t;
+                    closest = i;
+
+                    if (any_hit) {
+                        *distance = closest_distance;
+                        return closest;
+                    }
+                }
+            }
+        } else {
+            node_index = bvh_descend(bvh->nodes, node, node_index, ray,
+                                     closest_distance, stack, &stack_size);
+            if (node_index >= 0)
+                continue;
+        }
+
+        if (stack_size == 0)
+            break;
+
+        node_index = stack[--stack_size];
+    }
+
+    *distance = closest_distance;
+    return closest;
+}
+
+// the hit of the triangle (leaf order) at the distance
+bvh_hit_t bvh_make_hit(mesh_bvh_t const* bvh, Ray ray, int i,
+                       float distance) {
+    // facing the ray, as GetRayCollisionTriangle reports it
+    Vector3 normal = Vector3Normalize(
+        Vector3CrossProduct(bvh->triangles[i * 3 + 1], bvh->triangles[i * 3 + 2]));
+    if (Vector3DotProduct(normal, ray.direction) > 0)
+        normal = Vector3Negate(normal);
+
+    return (bvh_hit_t){
+        .collision = {.hit = true,
+                      .distance = distance,
+                      .point = Vector3Add(ray.position,
+                                          Vector3Scale(ray.direction, distance)),
+                      .normal = normal},
+        .mesh = -1,
+        .triangle = bvh->triangle_indices[i]};
+}
+
+bvh_hit_t mesh_bvh_closest_hit(mesh_bvh_t const* bvh, Ray ray,
+                               float max_distance) {
+    bvh_ray_t const r = bvh_setup_ray(ray);
+    float distance;
+    int const i = bvh_traverse(bvh, &r, max_distance, false, &distance);
+
+    if (i < 0)
+        return (bvh_hit_t){.mesh = -1, .triangle = -1};
+
+    return bvh_make_hit(bvh, ray, i, distance);
+}
+
+bool mesh_bvh_any_hit(mesh_bvh_t const* bvh, Ray ray, float max_distance) {
+    bvh_ray_t const r = bvh_setup_ray(ray);
+    float distance;
+    return bvh_traverse(bvh, &r, max_distance, true, &distance) >= 0;
+}
+
+// walks the tree over the meshes nearest first, so that the meshes
+// behind the closest hit are skipped by their root. the closest
+// triangle (leaf order) is written in triangle, -1 for none
+int model_bvh_traverse(model_bvh_t const* bvh, bvh_ray_t const* ray,
+                       float max_distance, bool any_hit, int* triangle,
+                       float* distance) {
+    *triangle = -1;
+
+    if (bvh->node_count == 0 ||
+        bvh_ray_box(ray, &bvh->nodes[0], max_distance) == INFINITY)
+        return -1;
+
+    int stack[BVH_MAX_DEPTH];
+    int stack_size = 0;
+    int node_index = 0;
+    int closest = -1;
+    float closest_distance = max_distance;
+
+    for (;;) {
+        bvh_node_t const* const node = &bvh->nodes[node_index];
+
+        if (node->count > 0) {
+            for (int i = node->offset; i < node->offset + node->count; i++) {
+                int const mesh = bvh->mesh_order[i];
+                float t;
+                int const hit = bvh_traverse(&bvh->meshes[mesh], ray,
+                                             closest_distance, any_hit, &t);
+
+                if (hit >= 0 && t < closest_distance) {
+                    closest_distance = t;
+                    closest = mesh;
+                    *triangle = hit;
+
+                    if (any_hit) {
+                        *distance = closest_distance;
+                        return closest;
+                    }
+                }
+            }
+        } else {
+            node_index = bvh_descend(bvh->nodes, node, node_index, ray,
+                                     closest_distance, stack, &stack_size);
+            if (node_index >= 0)
+                continue;
+        }
+
+        if (stack_size == 0)
+            break;
+
+        node_index = stack[--stack_size];
+    }
+
+    *distance = closest_distance;
+    return closest;
+}
+
+bvh_hit_t model_bvh_closest_hit(model_bvh_t const* bvh, Ray ray,
+                                float max_distance) {
+    bvh_ray_t const r = bvh_setup_ray(ray);
+    int triangle;
+    float distance;
+    int const mesh =
+        model_bvh_traverse(bvh, &r, max_distance, false, &triangle, &distance);
+
+    if (mesh < 0)
+        return (bvh_hit_t){.mesh = -1, .triangle = -1};
+
+    bvh_hit_t hit = bvh_make_hit(&bvh->meshes[mesh], ray, triangle, distance);
+    hit.mesh = mesh;
+    return hit;
+}
+
+bool model_bvh_any_hit(model_bvh_t const* bvh, Ray ray, float max_distance) {
+    bvh_ray_t const r = bvh_setup_ray(ray);
+    int triangle;
+    float distance;
+    return model_bvh_traverse(bvh, &r, max_distance, true, &triangle,
+                              &distance) >= 0;
+}
+
+Ray ray_to_model_space(Ray ray, Matrix transform) {
+    return ray_to_model_space_inverted(ray, MatrixInvert(transform));
+}
+
+Ray ray_to_model_space_inverted(Ray ray, Matrix inverse) {
+    Vector3 const origin = Vector3Transform(ray.position, inverse);
+    Vector3 const tip =
+        Vector3Transform(Vector3Add(ray.position, ray.direction), inverse);
+
+    return (Ray){.position = origin,
+                 .direction = Vector3Subtract(tip, origin)};
+}
@@ -0,0 +1,85 @@
+#ifndef SOURCE_BVH_C
+#define SOURCE_BVH_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// leaves hold up to this many triangles, more only when
+// the surface area heuristic can't split them
+#define BVH_MAX_LEAF_TRIANGLES ((int)4)
+// centroid bins the splits are evaluated at, per axis
+#define BVH_SAH_BINS ((int)12)
+// cost of visiting a node relative to intersecting a triangle
+#define BVH_TRAVERSAL_COST ((float)1)
+// nodes deep a traversal may go, the builds stay well under it
+#define BVH_MAX_DEPTH ((int)64)
+
+// a node of the depth-first flattened tree, 32 bytes. the first
+// child of an inner node is the next node, offset is the second one
+typedef struct {
+    Vector3 min;
+    // first triangle of a leaf, second child of an inner node
+    int offset;
+    Vector3 max;
+    // triangles of a leaf, 0 for an inner node
+    int count;
+} bvh_node_t;
+
+// the triangles of a mesh in leaf order, stored as a corner
+// and two edges for the intersection test
+typedef struct {
+    bvh_node_t* nodes;
+    int node_count;
+    // 3 vectors per triangle: v0, v1 - v0, v2 - v0
+    Vector3* triangles;
+    // index in the mesh of each triangle
+    int* triangle_indices;
+    int triangle_count;
+} mesh_bvh_t;
+
+// one tree per mesh, meshes parted by the frustum culling
+// or highlighted on their own stay queryable one by one
+typedef struct {
+    int mesh_count;
+    mesh_bvh_t* meshes;
+    // tree over the roots of the meshes, same layout as a mesh's:
+    // the leaves hold indices into mesh_order
+    bvh_node_t* nodes;
+    int node_count;
+    int* mesh_order;
+} model_bvh_t;
+
+// the closest intersection of a ray, in the space of the tree
+typedef struct {
+    RayCollision collision;
+    // -1 without a hit
+    int mesh;
+    int triangle;
+} bvh_hit_t;
+
+// sah-builds the trees of the model's meshes (cpu side only,
+// safe to call from worker threads)
+model_bvh_t build_model_bvh(Model const* model);
+void unload_model_bvh(model_bvh_t* bvh);
+size_t model_bvh_memory_size(model_bvh_t const* bvh);
+
+// rays are in model space, see ray_to_model_space.
+// only hits closer than max_distance count
+bvh_hit_t mesh_bvh_closest_hit(mesh_bvh_t const* bvh, Ray ray,
+                               float max_distance);
+bool mesh_bvh_any_hit(mesh_bvh_t const* bvh, Ray ray, float max_distance);
+
+bvh_hit_t model_bvh_closest_hit(model_bvh_t const* bvh, Ray ray,
+                                float max_distance);
+// whether anything is hit (shadow and occlusion queries,
+// stops at the first triangle found)
+bool model_bvh_any_hit(model_bvh_t const* bvh, Ray ray, float max_distance);
+
+// the world space ray in the space of a model drawn with the
+// transform. the direction isn't normalized again, so that the
+// distances of the hits stay world distances
+Ray ray_to_model_space(Ray ray, Matrix transform);
+// same with the transform already inverted, for repeated queries
+Ray ray_to_model_space_inverted(Ray ray, Matrix inverse);
+
+#endif
@@ -0,0 +1,142 @@
+#include "Catalogue.h"
+#include <string.h>
+#include <ctype.h>
+
+// strips the leading and trailing whitespaces in place
+char* trim(char* s) {
+    while (isspace((unsigned char)*s))
+        s++;
+
+    char* end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        end--;
+
+    *end = '\0';
+    return s;
+}
+
+// texture map slot matching a manifest key, -1 when none
+int catalogue_texture_key(char const* key) {
+    char const* const keys[WEAPON_TEXTURE_COUNT] = {
+        [WEAPON_TEXTURE_BASE_COLOR] = "base_color",
+        [WEAPON_TEXTURE_NORMAL] = "normal",
+        [WEAPON_TEXTURE_ROUGHNESS] = "roughness",
+        [WEAPON_TEXTURE_EMISSIVE] = "emissive"};
+
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT; i++)
+        if (strcmp(key, keys[i]) == 0)
+            return i;
+
+    return -1;
+}
+
+weapon_desc_t* catalogue_push(catalogue_t* catalogue, int* capacity) {
+    if (catalogue->count == *capacity) {
+        *capacity = *capacity > 0 ? *capacity * 2 : CATALOGUE_INITIAL_CAPACITY;
+        catalogue->descs =
+            realloc(catalogue->descs, sizeof(weapon_desc_t) * *capacity);
+    }
+
+    weapon_desc_t* const desc = &catalogue->descs[catalogue->count++];
+    *desc = (weapon_desc_t){.scale = 1};
+    return desc;
+}
+
+// drops the last entry when it's unusable
+void catalogue_validate_last(catalogue_t* catalogue,
+                             char const* manifest_path) {
+    if (catalogue->count == 0)
+        return;
+
+    weapon_desc_t const* const desc = &catalogue->descs[catalogue->count - 1];
+    if (desc->model_path != NULL)
+        return;
+
+    TraceLog(LOG_WARNING, "CATALOGUE: [%s] Weapon '%s' has no model, skipped",
+             manifest_path, desc->name);
+    catalogue->count--;
+}
+
+void catalogue_parse_property(weapon_desc_t* desc, char* line,
+                              char const* manifest_path, int line_number) {
+    char* const separator = strchr(line, '=');
+    if (separator == NULL) {
+        TraceLog(LOG_WARNING, "CATALOGUE: [%s:%d] Expected 'key = value'",
+                 manifest_path, line_number);
+        return;
+    }
+
+    *separator = '\0';
+    char const* const key = trim(line);
+    char* const value = trim(separator + 1);
+    int const texture = catalogue_texture_key(key);
+
+    if (strcmp(key, "model") == 0)
+        desc->model_path = value;
+    else if (strcmp(key, "scale") == 0)
+        desc->scale = strtof(value, NULL);
+    else if (texture >= 0)
+        desc->texture_paths[texture] = value;
+    else
+        TraceLog(LOG_WARNING, "CATALOGUE: [%s:%d] Unknown key '%s'",
+                 manifest_path, line_number, key);
+}
+
+bool load_catalogue(char const* manifest_path, catalogue_t* catalogue) {
+    *catalogue = (catalogue_t){0};
+
+    catalogue->text = LoadFileText(manifest_path);
+    if (catalogue->text == NULL)
+        return false;
+
+    int capacity = 0;
+    weapon_desc_t* desc = NULL;
+    int line_number = 0;
+
+    for (char* next = catalogue->text; next != NULL;) {
+        char* line = next;
+        line_number++;
+
+        next = strchr(line, '\n');
+        if (next != NULL)
+            *next++ = '\0';
+
+        line = trim(line);
+
+        // empty lines and comments
+        if (*line == '\0' || *line == '#')
+            continue;
+
+        // a new weapon entry, its header is the name
+        if (*line == '[') {
+            char* const end = strchr(line, ']');
+            if (end != NULL)
+                *end = '\0';
+
+            catalogue_validate_last(catalogue, manifest_path);
+            desc = catalogue_push(catalogue, &capacity);
+            desc->name = trim(line + 1);
+            continue;
+        }
+
+        if (desc == NULL) {
+            TraceLog(LOG_WARNING, "CATALOGUE: [%s:%d] Property out of entry",
+                     manifest_path, line_number);
+            continue;
+        }
+
+        catalogue_parse_property(desc, line, manifest_path, line_number);
+    }
+
+    catalogue_validate_last(catalogue, manifest_path);
+
+    TraceLog(LOG_INFO, "CATALOGUE: [%s] %d weapons", manifest_path,
+             catalogue->count);
+    return true;
+}
+
+void unload_catalogue(catalogue_t* catalogue) {
+    free(catalogue->descs);
+    UnloadFileText(catalogue->text);
+    *catalogue = (catalogue_t){0};
+}
@@ -0,0 +1,24 @@
+#ifndef SOURCE_CATALOGUE_C
+#define SOURCE_CATALOGUE_C
+
+#include "Base.h"
+#include "Loader.h"
+
+#define CATALOGUE_INITIAL_CAPACITY ((int)16)
+
+// weapons described by the manifest, in switch order
+typedef struct {
+    weapon_desc_t* descs;
+    int count;
+
+    // manifest text, parsed in place:
+    // every name and path of descs points into it
+    char* text;
+} catalogue_t;
+
+// parses the manifest, false when it can't be read.
+// malformed entries are skipped with a warning
+bool load_catalogue(char const* manifest_path, catalogue_t* catalogue);
+void unload_catalogue(catalogue_t* catalogue);
+
+#endif
@@ -1,133 +1,346 @@
 #include "Context.h"
 #include "Game.h"
 #include "Global.h"
-
-void ctx_update(ctx_t *ctx);
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "Loader.h"
+#include "Streaming.h"
+#include "TextureStreaming.h"
+#include "Catalogue.h"
+#include "StartupReport.h"
+#include <string.h>
+
+bool ctx_is_scene_dirty(ctx_t *ctx);
+void ctx_release_wireframe(ctx_t *ctx);
 void clear_bg();
 void ctx_drawing_update(ctx_t *ctx);
+void ctx_draw_current_weapon_emission(ctx_t *ctx);
+void init_ctx_hud(ctx_t *ctx);
 bool ctx_handle_ui(ctx_t *ctx);
 void ctx_listen_for_exit(ctx_t *ctx);
+void ctx_poll_input(ctx_t *ctx);
 bool is_input_exit();
+void ctx_begin_frame(ctx_t *ctx);
+void ctx_end_frame(ctx_t *ctx);
 
 void ctx_internal_update(ctx_t* ctx) {
-    UpdateCamera(&ctx->camera, CAMERA_ORBITAL);
+    double const start_time = profiler_time();
+
+    if (!ctx->is_input_scripted)
+        ctx_poll_input(ctx);
+
+    // scripted frames advance exactly one tick,
+    // so that benchmarks replay the same states
+    double const frame_time =
+        ctx->is_input_scripted ? ctx->sim_tick : GetFrameTime();
+    ctx_simulate(ctx, frame_time);
 
     ctx_update(ctx);
+    double const update_time = profiler_time();
+
+    bool const is_scene_dirty = ctx_is_scene_dirty(ctx);
+
+    ctx_begin_frame(ctx);
+        // otherwise the last resolved scene is presented again
+        if (is_scene_dirty) {
+            post_fx_begin_scene(&ctx->post_fx);
+                clear_bg();
+
+                BeginMode3D(ctx->camera);
+                    ctx_drawing_update(ctx);
+                EndMode3D();
+            post_fx_end_scene(&ctx->post_fx);
+
+            ctx_draw_current_weapon_emission(ctx);
+            post_fx_resolve(&ctx->post_fx);
+        }
+
+        // headless runs present into their own target,
+        // the window's backbuffer is never shown
+        if (ctx->offscreen_target != NULL)
+            BeginTextureMode(*ctx->offscreen_target);
 
-    BeginDrawing();
         clear_bg();
+        post_fx_present(&ctx->post_fx);
+        double const draw_3d_time = profiler_time();
 
-        BeginMode3D(ctx->camera);
-            ctx_drawing_update(ctx);
-        EndMode3D();
-        
         bool const is_continue_button_clicked = ctx_handle_ui(ctx);
-    EndDrawing();
+        double const ui_time = profiler_time();
+
+        if (ctx->offscreen_target != NULL)
+            EndTextureMode();
+    ctx_end_frame(ctx);
+
+    ctx->timings = (frame_timings_t){.update = update_time - start_time,
+                                     .draw_3d = draw_3d_time - update_time,
+                                     .ui = ui_time - draw_3d_time,
+                                     .present = profiler_time() - ui_time};
+
+    profiler_frame_mark();
 
     if (is_continue_button_clicked)
         start_game();
 }
 
-void ctx_loop(ctx_t *ctx) {
-    for (;;) {
-        ctx_listen_for_exit(ctx);
-        ctx_internal_update(ctx);
+// offscreen frames skip BeginDrawing and EndDrawing, which belong to the
+// window: its screen scale (zero without one), buffer swap, frame timing
+// and event polling. egl runs have no window at all, the run presents
+void ctx_begin_frame(ctx_t *ctx) {
+    if (ctx->offscreen_target == NULL) {
+        BeginDrawing();
+        return;
+    }
+
+    rlLoadIdentity();
+}
+
+void ctx_end_frame(ctx_t *ctx) {
+    if (ctx->offscreen_target == NULL) {
+        EndDrawing();
+        return;
     }
+
+    rlDrawRenderBatchActive();
 }
 
-void init_ctx_weapon_no_texture(ctx_t *ctx, uint8_t weapon_index,
-                                char const *model_path, char const *name,
-                                float scale) {
-    // setting model
-    ctx->weapons.models[weapon_index] = LoadModel(model_path);
+// whether the frame had an action or the mouse was used
+bool ctx_has_input(ctx_t *ctx) {
+    input_t const *const input = &ctx->input;
+    bool const has_input = input->zoom_in || input->zoom_out ||
+                           input->switch_next_weapon ||
+                           input->switch_previous_weapon ||
+                           input->toggle_profiler || input->dump_trace ||
+                           input->toggle_orbit;
+    bool const has_mouse_input =
+        Vector2LengthSqr(GetMouseDelta()) > 0 ||
+        IsMouseButtonDown(MOUSE_BUTTON_LEFT) || GetMouseWheelMove() != 0;
 
-    // setting miscs
-    ctx->weapons.names[weapon_index] = name;
-    ctx->weapons.scales[weapon_index] = scale;
+    return has_input || has_mouse_input;
 }
 
-void init_ctx_weapon(ctx_t *ctx, uint8_t weapon_index,
-                     char const *base_color_path, char const *normal_path,
-                     char const *roughness_path, char const *emissive_path,
-                     char const *model_path, char const *name, float scale) {
-    // loading base model
-    init_ctx_weapon_no_texture(ctx, weapon_index, model_path, name, scale);
+// whether the frame had input, a moving camera (orbit or zoom) or
+// a loading weapon, otherwise nothing moves and the rate can drop
+bool ctx_is_active(ctx_t *ctx) {
+    if (ctx_has_input(ctx) || ctx->sim.is_orbiting ||
+        fabsf(ctx->sim.zoom_state) > ZOOM_IDLE_EPSILON)
+        return true;
 
-    // loading texture base color
-    ctx->weapons.models[weapon_index]
-        .materials[0]
-        .maps[MATERIAL_MAP_DIFFUSE]
-        .texture = LoadTexture(base_color_path);
+    for (int i = 0; i < ctx->weapons.count; i++)
+        if (ctx->weapons.residencies[i] == WEAPON_LOADING)
+            return true;
 
-    // loading texture normal
-    if (normal_path != NULL)
-        ctx->weapons.models[weapon_index]
-            .materials[0]
-            .maps[MATERIAL_MAP_NORMAL]
-            .texture = LoadTexture(normal_path);
+    return false;
+}
+
+void ctx_loop(ctx_t *ctx) {
+    // raylib doesn't cap the rate (no SetTargetFPS),
+    // the pacer does, keeping the ticks at their own rate
+    for (;;) {
+        ctx_listen_for_exit(ctx);
+        ctx_internal_update(ctx);
 
-    // loading texture roughness
-    if (roughness_path != NULL)
-        ctx->weapons.models[weapon_index]
-            .materials[0]
-            .maps[MATERIAL_MAP_ROUGHNESS]
-            .texture = LoadTexture(roughness_path);
+        if (ctx_is_active(ctx))
+            frame_pacer_mark_activity(&ctx->pacer);
 
-    // loading texture emissive
-    if (emissive_path != NULL)
-        ctx->weapons.models[weapon_index]
-            .materials[0]
-            .maps[MATERIAL_MAP_EMISSION]
-            .texture = LoadTexture(emissive_path);
+        frame_pacer_wait(&ctx->pacer);
+    }
 }
 
-void deinit_ctx_weapon(ctx_t *ctx, uint8_t weapon_index) {
-    // unloading model
-    UnloadModel(ctx->weapons.models[weapon_index]);
+// loads the manifest, the demo can't run without weapons
+void init_ctx_catalogue(catalogue_t *catalogue) {
+    if (!load_catalogue(WEAPONS_MANIFEST_PATH, catalogue) ||
+        catalogue->count == 0)
+        TraceLog(LOG_FATAL, "CATALOGUE: [%s] No weapons to show",
+                 WEAPONS_MANIFEST_PATH);
 }
 
 void init_ctx_weapons(ctx_t *ctx) {
-    init_ctx_weapon(ctx, 0, "Res/Pistol/BaseColor.png", "Res/Pistol/Normal.png",
-                    "Res/Pistol/Roughness.png", NULL, "Res/Pistol/Model.obj",
-                    "PISTOL", 1);
-    init_ctx_weapon(ctx, 1, "Res/MachineGun/BaseColor.png",
-                    "Res/MachineGun/Normal.png", "Res/MachineGun/Roughness.png",
-                    NULL, "Res/MachineGun/Model.obj", "MACHINE GUN", 2);
-    init_ctx_weapon(ctx, 2, "Res/Rifle/BaseColor0.png", NULL, NULL,
-                    "Res/Rifle/Emissive.png", "Res/Rifle/Model.obj", "RIFLE",
-                    0.7);
+    init_ctx_catalogue(&ctx->catalogue);
+
+    // sizing the catalogue arrays
+    weapons_t *const weapons = &ctx->weapons;
+    int const count = ctx->catalogue.count;
+    weapons->count = count;
+    weapons->descs = ctx->catalogue.descs;
+    weapons->models = calloc(count, sizeof(Model));
+    weapons->lods = calloc(count, sizeof(model_lods_t));
+    weapons->bvhs = calloc(count, sizeof(model_bvh_t));
+    weapons->scales = calloc(count, sizeof(float));
+    weapons->names = calloc(count, sizeof(char const *));
+    weapons->residencies = calloc(count, sizeof(weapon_residency_t));
+    weapons->loads = calloc(count, sizeof(weapon_load_t));
+    weapons->load_groups = calloc(count, sizeof(job_group_t));
+    weapons->sizes = calloc(count, sizeof(size_t));
+    weapons->texture_streams =
+        calloc(count, sizeof(weapon_texture_stream_t[WEAPON_TEXTURE_COUNT]));
+
+    for (int i = 0; i < count; i++) {
+        weapons->names[i] = weapons->descs[i].name;
+        weapons->scales[i] = weapons->descs[i].scale;
+    }
+
+    ctx->weapon_streaming = WEAPON_STREAMING;
+    ctx->weapon_streaming_neighbours = WEAPON_STREAMING_NEIGHBOURS;
+    ctx->weapon_streaming_budget = WEAPON_STREAMING_BUDGET;
+    // a cpu only ctx has no textures to stream
+    ctx->texture_streaming = TEXTURE_STREAMING && !ctx->is_cpu_only;
+    ctx->texture_streaming_initial_size = TEXTURE_STREAMING_INITIAL_SIZE;
+
+    init_ctx_weapons_streaming(ctx);
+}
+
+void bake_ctx_weapons() {
+    catalogue_t catalogue;
+    init_ctx_catalogue(&catalogue);
+
+    for (int i = 0; i < catalogue.count; i++) {
+        bake_model(catalogue.descs[i].model_path);
+
+        for (int j = 0; j < WEAPON_TEXTURE_COUNT; j++)
+            if (catalogue.descs[i].texture_paths[j] != NULL)
+                bake_texture(catalogue.descs[i].texture_paths[j]);
+    }
+
+    unload_catalogue(&catalogue);
 }
 
 void deinit_ctx_weapons(ctx_t *ctx) {
-    for (uint8_t i = 0; i < WEAPONS_COUNT; i++)
-        deinit_ctx_weapon(ctx, i);
+    deinit_ctx_weapons_streaming(ctx);
+
+    weapons_t *const weapons = &ctx->weapons;
+    free(weapons->models);
+    free(weapons->lods);
+    free(weapons->bvhs);
+    free(weapons->scales);
+    free(weapons->names);
+    free(weapons->residencies);
+    free(weapons->loads);
+    free(weapons->load_groups);
+    free(weapons->sizes);
+    free(weapons->texture_streams);
+
+    unload_catalogue(&ctx->catalogue);
+}
+
+int ctx_screen_width() {
+    return IsWindowReady() ? GetScreenWidth() : (int)SCREEN_W;
+}
+
+int ctx_screen_height() {
+    return IsWindowReady() ? GetScreenHeight() : (int)SCREEN_H;
+}
+
+// what init_ctx and init_ctx_cpu share, once the font is loaded
+void init_ctx_state(ctx_t *ctx) {
+    init_text_cache(&ctx->text_cache);
+    init_jobs(&ctx->jobs, 0);
+    ctx->offscreen_target = NULL;
+    ctx->visible_meshes = NULL;
+    ctx->visible_meshes_capacity = 0;
+    ctx->cull_stats = (cull_stats_t){0};
+    ctx->input = (input_t){0};
+    ctx->is_input_scripted = false;
+    ctx->timings = (frame_timings_t){0};
+    ctx->selected_weapon = 0;
+    ctx->hovered_mesh = -1;
+    ctx->hover_inverse_weapon = -1;
+    ctx->wireframe = (model_wireframe_t){0};
+    ctx->wireframe_weapon = -1;
+    init_ctx_weapons(ctx);
+    init_ctx_hud(ctx);
+
+    ctx->sim = (sim_state_t){.fovy = CAMERA_START_FOVY,
+                             .zoom_state = ZOOM_STOP_TARGET,
+                             .orbit_angle = 0,
+                             .is_orbiting = true};
+    ctx->previous_sim = ctx->sim;
+    ctx->sim_accumulator = 0;
+    ctx->sim_tick = 1 / SIM_TICK_RATE;
+    init_frame_pacer(&ctx->pacer, FRAME_PACING_TARGET_RATE,
+                     FRAME_PACING_IDLE_RATE, FRAME_PACING_IDLE_DELAY);
+    ctx->render_on_demand = RENDER_ON_DEMAND;
+    ctx->is_scene_valid = false;
+    ctx->drawn_scenes = 0;
+    ctx->reused_scenes = 0;
+    ctx->last_input_time = GetTime();
+    ctx->is_orbit_idle_paused = false;
+    ctx->camera = sim_camera(&ctx->sim, &ctx->sim, 0);
+
+    startup_report_finish(STARTUP_REPORT_PATH);
+}
+
+void ctx_report_font(double font_start, bool font_from_cache) {
+    char font_cache[FONT_CACHE_PATH_MAX_LENGTH];
+    font_cache_path(FONT_PATH, font_cache, sizeof(font_cache));
+    startup_report_add(font_from_cache ? "font_cache" : "font", FONT_PATH,
+                       font_start,
+                       startup_asset_bytes(font_from_cache ? font_cache
+                                                           : FONT_PATH));
 }
 
 void init_ctx(ctx_t *ctx) {
     SetExitKey(KEY_NULL);
     SetRandomSeed(GetTime() * 100);
+    ctx->is_cpu_only = false;
 
-    ctx->font = LoadFontEx("Res/IBM3270.ttf", FONT_RESOLUTION, NULL, 0);
-    SetTextureFilter(ctx->font.texture, TEXTURE_FILTER_BILINEAR);
+    double const font_start = profiler_time();
+    bool font_from_cache;
+    ctx->font = load_font_sdf(FONT_PATH, &font_from_cache);
+    ctx->font_shader = LoadShader(NULL, FONT_SDF_SHADER_PATH);
+    ctx_report_font(font_start, font_from_cache);
 
-    // ctx->screen_shader_target = LoadRenderTexture(SCREEN_W, SCREEN_H);
-    // ctx->shader = LoadShader(NULL, "Res/Shaders/Normal.fs");
+    init_post_fx(&ctx->post_fx, ctx_screen_width(), ctx_screen_height());
+    ctx->wireframe_shader = load_wireframe_shader();
 
-    init_ctx_weapons(ctx);
-    ctx->selected_weapon = 0;
+    init_ctx_state(ctx);
+}
+
+void init_ctx_cpu(ctx_t *ctx) {
+    SetRandomSeed(profiler_time() * 100);
+    ctx->is_cpu_only = true;
 
-    ctx->camera = (Camera3D){.position = vec3(-10, 15, -10),
-                             .target = vec3(0, 0, 0),
-                             .up = vec3(0, 1, 0),
-                             .fovy = 45,
-                             .projection = CAMERA_PERSPECTIVE};
+    double const font_start = profiler_time();
+    bool font_from_cache;
+    Image atlas;
+    ctx->font = load_font_sdf_cpu(FONT_PATH, &atlas, &font_from_cache);
+
+    if (ctx->font.glyphs == NULL)
+        TraceLog(LOG_FATAL, "FONTCACHE: [%s] No font to draw the hud",
+                 FONT_PATH);
+
+    // the layouts only need the atlas size for their texcoords
+    ctx->font.texture = (Texture2D){.width = atlas.width,
+                                    .height = atlas.height,
+                                    .mipmaps = 1,
+                                    .format = atlas.format};
+    UnloadImage(atlas);
+    ctx_report_font(font_start, font_from_cache);
+
+    ctx->font_shader = (Shader){0};
+    ctx->post_fx = (post_fx_t){0};
+    ctx->wireframe_shader = (wireframe_shader_t){0};
+
+    init_ctx_state(ctx);
 }
 
 void deinit_ctx(ctx_t *ctx) {
-    UnloadFont(ctx->font);
-    // UnloadRenderTexture(ctx->screen_shader_target);
-    // UnloadShader(ctx->shader);
+    deinit_ui(&ctx->ui);
+    deinit_text_cache(&ctx->text_cache);
+    ctx_release_wireframe(ctx);
     deinit_ctx_weapons(ctx);
+    deinit_jobs(&ctx->jobs);
+    free(ctx->visible_meshes);
+
+    if (ctx->is_cpu_only) {
+        UnloadFontData(ctx->font.glyphs, ctx->font.glyphCount);
+        RL_FREE(ctx->font.recs);
+        return;
+    }
+
+    UnloadFont(ctx->font);
+    UnloadShader(ctx->font_shader);
+    deinit_post_fx(&ctx->post_fx);
+    unload_wireframe_shader(ctx->wireframe_shader);
 }
 
 void ctx_exit(ctx_t *ctx) {
@@ -158,17 +371,36 @@ bool is_input_switch_previous_weapon() {
            IsKeyPressed(KEY_TAB);
 }
 
-bool is_fovy_in_bounds(float fovy) {
-    return IS_IN_INCLUSIVE_RANGE(fovy, 10, 100);
+bool is_input_toggle_profiler() {
+    return IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_P);
 }
 
-float delta_time() {
-    return GetFrameTime();
+bool is_input_dump_trace() {
+    return IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_T);
 }
 
-void update_camera_from_zoom(float *fovy, float zoom_state) {
+bool is_input_toggle_orbit() {
+    return IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_O);
+}
+
+void ctx_poll_input(ctx_t *ctx) {
+    ctx->input = (input_t){
+        .zoom_in = is_input_zoom_in(),
+        .zoom_out = is_input_zoom_out(),
+        .switch_next_weapon = is_input_switch_next_weapon(),
+        .switch_previous_weapon = is_input_switch_previous_weapon(),
+        .toggle_profiler = is_input_toggle_profiler(),
+        .dump_trace = is_input_dump_trace(),
+        .toggle_orbit = is_input_toggle_orbit()};
+}
+
+bool is_fovy_in_bounds(float fovy) {
+    return IS_IN_INCLUSIVE_RANGE(fovy, 10, 100);
+}
+
+void update_camera_from_zoom(float *fovy, float zoom_state, float dt) {
     float const r =
-        *fovy + ZOOM_STEP * delta_time() * ZOOM_DELTATIME_FACTOR * zoom_state;
+        *fovy + ZOOM_STEP * dt * ZOOM_DELTATIME_FACTOR * zoom_state;
 
     if (!is_fovy_in_bounds(r))
         return;
@@ -176,6 +408,64 @@ void update_camera_from_zoom(float *fovy, float zoom_state) {
     *fovy = r;
 }
 
+void sim_zoom_smoothly(float *zoom_state, float target, float dt) {
+    *zoom_state =
+        Lerp(*zoom_state, target, ZOOM_SMOOTH_STEP * dt * ZOOM_DELTATIME_FACTOR);
+}
+
+// a single fixed step of the simulation
+void sim_tick(sim_state_t *sim, input_t const *input, float dt) {
+    if (input->zoom_in)
+        sim_zoom_smoothly(&sim->zoom_state, ZOOM_IN_TARGET, dt);
+    else if (input->zoom_out)
+        sim_zoom_smoothly(&sim->zoom_state, ZOOM_OUT_TARGET, dt);
+    else
+        sim_zoom_smoothly(&sim->zoom_state, ZOOM_STOP_TARGET, dt);
+
+    // the smoothing only tends to the stop, settling it makes
+    // the fovy (and the scene key) stop changing
+    if (!input->zoom_in && !input->zoom_out &&
+        fabsf(sim->zoom_state) <= ZOOM_IDLE_EPSILON)
+        sim->zoom_state = ZOOM_STOP_TARGET;
+
+    update_camera_from_zoom(&sim->fovy, sim->zoom_state, dt);
+
+    if (sim->is_orbiting)
+        sim->orbit_angle += CAMERA_ORBIT_SPEED * dt;
+}
+
+// the camera between two ticks, alpha going from previous (0) to current (1)
+Camera3D sim_camera(sim_state_t const *previous, sim_state_t const *current,
+                    float alpha) {
+    Vector3 const up = vec3(0, 1, 0);
+    float const angle = Lerp(previous->orbit_angle, current->orbit_angle, alpha);
+
+    return (Camera3D){
+        .position = Vector3RotateByAxisAngle(CAMERA_START_POSITION, up, angle),
+        .target = vec3(0, 0, 0),
+        .up = up,
+        .fovy = Lerp(previous->fovy, current->fovy, alpha),
+        .projection = CAMERA_PERSPECTIVE};
+}
+
+// runs the ticks the frame time covers, then
+// interpolates the camera drawn by the frame
+void ctx_simulate(ctx_t *ctx, double frame_time) {
+    PROFILE_ZONE("ctx_simulate");
+
+    ctx->sim_accumulator +=
+        fmin(frame_time, ctx->sim_tick * SIM_MAX_TICKS_PER_FRAME);
+
+    while (ctx->sim_accumulator >= ctx->sim_tick) {
+        ctx->previous_sim = ctx->sim;
+        sim_tick(&ctx->sim, &ctx->input, (float)ctx->sim_tick);
+        ctx->sim_accumulator -= ctx->sim_tick;
+    }
+
+    ctx->camera = sim_camera(&ctx->previous_sim, &ctx->sim,
+                             (float)(ctx->sim_accumulator / ctx->sim_tick));
+}
+
 void draw_test_cube() {
     Vector3 const pos = vec3(0, 1, 0);
     Vector3 const size = vec3(2, 2, 2);
@@ -197,87 +487,305 @@ char const *ctx_cur_weapon_name(ctx_t *ctx) {
     return ctx->weapons.names[ctx->selected_weapon];
 }
 
-void ctx_draw_current_weapon(ctx_t *ctx) {
-    Vector3 const pos = scalar_to_vec3(0);
+// the weapon fades into its wireframe when zooming in too much
+uint8_t ctx_cur_weapon_alpha(ctx_t *ctx) {
     // the fovy value the model should start
     // to get faded
     float const fading_fovy_limit = 13;
 
-    uint8_t model_alpha;
     if (ctx->camera.fovy < fading_fovy_limit)
-        model_alpha = FROM_XRANGE_TO_YRANGE(ctx->camera.fovy, ZOOM_MIN,
-                                            fading_fovy_limit, 0, 255);
+        return FROM_XRANGE_TO_YRANGE(ctx->camera.fovy, ZOOM_MIN,
+                                     fading_fovy_limit, 0, 255);
+
+    return 255;
+}
+
+void ctx_release_wireframe(ctx_t *ctx) {
+    if (ctx->wireframe_weapon < 0)
+        return;
+
+    if (ctx->is_cpu_only)
+        unload_model_wireframe_cpu(&ctx->wireframe);
     else
-        model_alpha = 255;
+        unload_model_wireframe(&ctx->wireframe);
 
-    const uint8_t model_alpha_inversed = 255 - model_alpha;
+    ctx->wireframe_weapon = -1;
+}
+
+// an unindexed copy of every mesh, about three times the weapon's
+// vertex memory, so only the selected weapon gets one
+model_wireframe_t const *ctx_cur_weapon_wireframe(ctx_t *ctx) {
+    if (ctx->wireframe_weapon != ctx->selected_weapon) {
+        ctx_release_wireframe(ctx);
+
+        Model const model = ctx_cur_weapon(ctx);
+        ctx->wireframe = generate_model_wireframe(&model);
+
+        if (!ctx->is_cpu_only)
+            upload_model_wireframe(&ctx->wireframe);
+        ctx->wireframe_weapon = ctx->selected_weapon;
+    }
 
-    DrawModel(ctx_cur_weapon(ctx), pos, ctx_cur_weapon_scale(ctx),
-              color(255, 255, 255, model_alpha));
-    DrawModelWires(ctx_cur_weapon(ctx), pos, ctx_cur_weapon_scale(ctx),
-                   color(255, 255, 255, model_alpha_inversed));
+    return &ctx->wireframe;
 }
 
-void ctx_zoom_smoothly(float *zoom_state, float target) {
-    *zoom_state = Lerp(*zoom_state, target,
-                       ZOOM_SMOOTH_STEP * delta_time() * ZOOM_DELTATIME_FACTOR);
+// the current weapon at the level of detail its size on screen needs
+Model ctx_cur_weapon_lod(ctx_t *ctx, Vector3 pos) {
+    // the narrower the fovy, the bigger the model on
+    // screen and the finer the level it needs
+    model_lods_t const *const lods = &ctx->weapons.lods[ctx->selected_weapon];
+    int const level = select_lod(lods, ctx->camera, pos,
+                                 ctx_cur_weapon_scale(ctx),
+                                 ctx_screen_height());
+
+    return lod_model(ctx_cur_weapon(ctx), lods, level);
 }
 
-void ctx_handle_zoom(ctx_t *ctx) {
-    static float smooth_zoom_state = 0;
+// flags the meshes of the current weapon the camera sees, counting
+// the triangles of the meshes about to be drawn (inside the 3d mode)
+void ctx_cull_current_weapon(ctx_t *ctx, Mesh const *meshes, Vector3 pos) {
+    Model const model = ctx_cur_weapon(ctx);
 
-    if (is_input_zoom_in())
-        ctx_zoom_smoothly(&smooth_zoom_state, ZOOM_IN_TARGET);
-    else if (is_input_zoom_out())
-        ctx_zoom_smoothly(&smooth_zoom_state, ZOOM_OUT_TARGET);
-    else
-        ctx_zoom_smoothly(&smooth_zoom_state, ZOOM_STOP_TARGET);
+    if (model.meshCount > ctx->visible_meshes_capacity) {
+        ctx->visible_meshes_capacity = model.meshCount;
+        ctx->visible_meshes =
+            realloc(ctx->visible_meshes, sizeof(bool) * model.meshCount);
+    }
+
+    // the bounds are in model space, the frustum is brought there
+    Matrix const transform =
+        model_draw_transform(model, pos, ctx_cur_weapon_scale(ctx));
+    frustum_t const frustum = frustum_from_matrix(rl_current_mvp(transform));
 
-    update_camera_from_zoom(&ctx->camera.fovy, smooth_zoom_state);
+    ctx->cull_stats = (cull_stats_t){0};
+    cull_meshes(&frustum, meshes,
+                ctx->weapons.lods[ctx->selected_weapon].mesh_bounds,
+                model.meshCount, ctx->visible_meshes, &ctx->cull_stats);
+}
+
+void ctx_draw_current_weapon(ctx_t *ctx) {
+    // still streaming in
+    if (!ctx_is_weapon_resident(ctx, ctx->selected_weapon))
+        return;
+
+    Vector3 const pos = scalar_to_vec3(0);
+    uint8_t const model_alpha = ctx_cur_weapon_alpha(ctx);
+    const uint8_t model_alpha_inversed = 255 - model_alpha;
+
+    // fully solid, the wireframe would be invisible
+    if (model_alpha == 255) {
+        Model const lod = ctx_cur_weapon_lod(ctx, pos);
+        ctx_cull_current_weapon(ctx, lod.meshes, pos);
+        draw_model_visible(lod, ctx->visible_meshes, pos,
+                           ctx_cur_weapon_scale(ctx), WHITE);
+        return;
+    }
+
+    // fading, solid and wires are blended in the same pass
+    model_wireframe_t const *const wireframe = ctx_cur_weapon_wireframe(ctx);
+    ctx_cull_current_weapon(ctx, wireframe->meshes, pos);
+    draw_model_crossfade(ctx_cur_weapon(ctx), wireframe, &ctx->wireframe_shader,
+                         ctx->visible_meshes, pos, ctx_cur_weapon_scale(ctx),
+                         color(255, 255, 255, model_alpha),
+                         color(255, 255, 255, model_alpha_inversed));
+}
+
+// bloom source, only weapons with an emission map glow
+void ctx_draw_current_weapon_emission(ctx_t *ctx) {
+    if (!ctx_is_weapon_resident(ctx, ctx->selected_weapon) ||
+        !model_has_emission(ctx_cur_weapon(ctx)))
+        return;
+
+    Vector3 const pos = scalar_to_vec3(0);
+    // same meshes as the 3d pass, the frustum having the same aspect
+    post_fx_draw_emission(&ctx->post_fx, ctx->camera,
+                          ctx_cur_weapon_lod(ctx, pos), ctx->visible_meshes,
+                          pos, ctx_cur_weapon_scale(ctx),
+                          color(255, 255, 255, ctx_cur_weapon_alpha(ctx)));
 }
 
 void ctx_switch_weapon(ctx_t *ctx, int8_t switch_direction) {
-    int16_t const r = ctx->selected_weapon + (int16_t)switch_direction;
+    int const r = ctx->selected_weapon + switch_direction;
 
-    if (!IS_IN_RANGE(r, 0, WEAPONS_COUNT))
+    if (!IS_IN_RANGE(r, 0, ctx->weapons.count))
         return;
 
     ctx->selected_weapon = r;
 }
 
 void ctx_handle_weapon_switch(ctx_t *ctx) {
-    if (is_input_switch_previous_weapon())
+    if (ctx->input.switch_previous_weapon)
         ctx_switch_weapon(ctx, WEAPON_SWITCH_DIRECTION_PREVIOUS);
-    else if (is_input_switch_next_weapon())
+    else if (ctx->input.switch_next_weapon)
         ctx_switch_weapon(ctx, WEAPON_SWITCH_DIRECTION_NEXT);
+
+    // the wireframe of a deselected weapon isn't kept around
+    if (ctx->wireframe_weapon != ctx->selected_weapon)
+        ctx_release_wireframe(ctx);
+}
+
+// pausing the orbit leaves the camera still,
+// so that the scene stops being redrawn
+void ctx_handle_orbit(ctx_t *ctx) {
+    if (ctx->input.toggle_orbit)
+        ctx->sim.is_orbiting = !ctx->sim.is_orbiting;
+}
+
+// the orbit changes the scene key every frame, so when rendering
+// on demand an unattended demo stops orbiting and its frames reuse
+// the scene. scripted runs replay the same frames whatever the time
+void ctx_handle_idle_orbit(ctx_t *ctx) {
+    if (!ctx->render_on_demand || ctx->is_input_scripted)
+        return;
+
+    double const now = GetTime();
+
+    if (ctx_has_input(ctx)) {
+        ctx->last_input_time = now;
+
+        if (ctx->is_orbit_idle_paused) {
+            ctx->sim.is_orbiting = true;
+            ctx->is_orbit_idle_paused = false;
+        }
+
+        return;
+    }
+
+    if (ctx->sim.is_orbiting &&
+        now - ctx->last_input_time >= ORBIT_IDLE_PAUSE_DELAY) {
+        ctx->sim.is_orbiting = false;
+        ctx->is_orbit_idle_paused = true;
+    }
+}
+
+void ctx_handle_profiler(ctx_t *ctx) {
+    if (ctx->input.toggle_profiler)
+        profiler_set_enabled(!profiler_is_enabled());
+
+    if (ctx->input.dump_trace)
+        profiler_dump_trace(PROFILER_TRACE_PATH);
+}
+
+// picks the part of the weapon under the mouse through its bvh
+void ctx_handle_hover(ctx_t *ctx) {
+    PROFILE_ZONE("ctx_handle_hover");
+
+    ctx->hovered_mesh = -1;
+
+    // a scripted frame's mouse isn't part of the script,
+    // a cpu only ctx has no window to point at
+    if (ctx->is_input_scripted || ctx->is_cpu_only ||
+        !ctx_is_weapon_resident(ctx, ctx->selected_weapon))
+        return;
+
+    // the draw transform of a weapon never changes,
+    // it's inverted once rather than for every query
+    if (ctx->hover_inverse_weapon != ctx->selected_weapon) {
+        ctx->hover_inverse = MatrixInvert(model_draw_transform(
+            ctx_cur_weapon(ctx), scalar_to_vec3(0), ctx_cur_weapon_scale(ctx)));
+        ctx->hover_inverse_weapon = ctx->selected_weapon;
+    }
+
+    Ray const ray = GetMouseRay(GetMousePosition(), ctx->camera);
+    bvh_hit_t const hit = model_bvh_closest_hit(
+        &ctx->weapons.bvhs[ctx->selected_weapon],
+        ray_to_model_space_inverted(ray, ctx->hover_inverse), INFINITY);
+
+    ctx->hovered_mesh = hit.mesh;
 }
 
 void ctx_update(ctx_t *ctx) {
-    ctx_handle_zoom(ctx);
+    PROFILE_ZONE("ctx_update");
+
+    ctx_handle_profiler(ctx);
+    ctx_handle_orbit(ctx);
+    ctx_handle_idle_orbit(ctx);
     ctx_handle_weapon_switch(ctx);
+    ctx_update_weapon_streaming(ctx);
+    ctx_update_texture_streaming(ctx);
+    ctx_handle_hover(ctx);
+}
+
+scene_key_t ctx_scene_key(ctx_t *ctx) {
+    scene_key_t key = {.camera = ctx->camera,
+                       .selected_weapon = ctx->selected_weapon,
+                       .is_weapon_resident = ctx_is_weapon_resident(
+                           ctx, ctx->selected_weapon),
+                       .hovered_mesh = ctx->hovered_mesh,
+                       .textures_hash = 0};
+
+    if (!key.is_weapon_resident)
+        return key;
+
+    Model const model = ctx_cur_weapon(ctx);
+    for (int i = 0; i < model.materialCount; i++)
+        for (int map = 0; map < MATERIAL_MAP_BRDF + 1; map++)
+            key.textures_hash = key.textures_hash * 31 +
+                                model.materials[i].maps[map].texture.id;
+
+    return key;
+}
+
+bool scene_keys_equal(scene_key_t const *a, scene_key_t const *b) {
+    return memcmp(&a->camera, &b->camera, sizeof(a->camera)) == 0 &&
+           a->selected_weapon == b->selected_weapon &&
+           a->is_weapon_resident == b->is_weapon_resident &&
+           a->hovered_mesh == b->hovered_mesh &&
+           a->textures_hash == b->textures_hash;
+}
+
+// whether the 3d pass must be drawn again this frame
+bool ctx_is_scene_dirty(ctx_t *ctx) {
+    scene_key_t const key = ctx_scene_key(ctx);
+    bool const is_dirty = !ctx->render_on_demand || !ctx->is_scene_valid ||
+                          !scene_keys_equal(&key, &ctx->scene_key);
+
+    ctx->scene_key = key;
+    ctx->is_scene_valid = true;
+
+    if (is_dirty)
+        ctx->drawn_scenes++;
+    else
+        ctx->reused_scenes++;
+
+    return is_dirty;
+}
+
+// the bounds of the hovered part, in the weapon's space
+void ctx_draw_hovered_mesh(ctx_t *ctx) {
+    if (ctx->hovered_mesh < 0)
+        return;
+
+    float16 const transform = MatrixToFloatV(model_draw_transform(
+        ctx_cur_weapon(ctx), scalar_to_vec3(0), ctx_cur_weapon_scale(ctx)));
+    BoundingBox const bounds =
+        ctx->weapons.lods[ctx->selected_weapon].mesh_bounds[ctx->hovered_mesh];
+
+    rlPushMatrix();
+        rlMultMatrixf(transform.v);
+        DrawBoundingBox(bounds, WEAPON_HOVER_COLOR);
+    rlPopMatrix();
 }
 
 void ctx_drawing_update(ctx_t *ctx) {
+    PROFILE_ZONE("ctx_drawing_update");
+
     ctx_draw_current_weapon(ctx);
+    ctx_draw_hovered_mesh(ctx);
 }
 
 void clear_bg() {
     ClearBackground(BACKGROUND_COLOR);
 }
 
-void ui_draw_fps(Font font) {
-    char buf[UI_DEBUG_TEXT_MAX_LENGTH];
-    sprintf_s(buf, sizeof(buf), "fps: %d", GetFPS());
-
-    DrawTextEx(font, buf, scalar_to_vec2(UI_EDGE_OFFSET), UI_DEBUG_FONT_SIZE,
-               UI_DEBUG_FONT_SPACING, GRAY);
-}
-
-float measure_text_width(Font font, char const *buf) {
-    return MeasureTextEx(font,
-                         buf,
-                         UI_DEBUG_FONT_SIZE,
-                         UI_DEBUG_FONT_SPACING).x;
+void ui_update_fps(ui_t *ui, hud_t *hud) {
+    // formatted again only when the value changes
+    int const fps = GetFPS();
+    if (fps != hud->last_fps) {
+        sprintf_s(hud->fps_text, sizeof(hud->fps_text), "fps: %d", fps);
+        hud->last_fps = fps;
+        ui_set_text(ui, hud->fps, hud->fps_text);
+    }
 }
 
 float calculate_zoom_percentage_from_fovy(float fovy) {
@@ -287,62 +795,97 @@ float calculate_zoom_percentage_from_fovy(float fovy) {
                                  0, 100);
 }
 
-void ui_draw_zoom_percentage(Font font, float fovy) {
-    float const zoom_percentage = calculate_zoom_percentage_from_fovy(fovy);
-    char buf[UI_DEBUG_TEXT_MAX_LENGTH];
-    sprintf_s(buf, sizeof(buf), "zoom: %.0f%%", zoom_percentage);
-
-    DrawTextEx(font, buf,
-               vec2(SCREEN_W - UI_EDGE_OFFSET - measure_text_width(font, buf),
-                    UI_EDGE_OFFSET),
-               UI_DEBUG_FONT_SIZE, UI_DEBUG_FONT_SPACING, GRAY);
-}
-
-void ui_draw_weapon_name_and_index(Font font, char const *name, uint8_t index) {
-    Vector2 const text_size =
-        MeasureTextEx(font, name, WEAPON_INFO_FONT_SIZE, UI_DEBUG_FONT_SPACING);
+void ui_update_zoom_percentage(ui_t *ui, hud_t *hud, float fovy) {
+    // formatted again only when the displayed value changes
+    int const zoom_percentage =
+        (int)roundf(calculate_zoom_percentage_from_fovy(fovy));
+    if (zoom_percentage == hud->last_zoom_percentage)
+        return;
 
-    float const yoffset = 19;
-    Vector2 const text_pos =
-        vec2(UI_EDGE_OFFSET, SCREEN_H - UI_EDGE_OFFSET - text_size.y - yoffset);
+    sprintf_s(hud->zoom_text, sizeof(hud->zoom_text), "zoom: %d%%",
+              zoom_percentage);
+    hud->last_zoom_percentage = zoom_percentage;
 
-    // drawing the name of the weapon
-    DrawTextEx(font, name, text_pos, WEAPON_INFO_FONT_SIZE,
-               UI_DEBUG_FONT_SPACING, WEAPON_NAME_COLOR);
+    // right aligned
+    ui_set_text(ui, hud->zoom, hud->zoom_text);
+    ui_set_position(ui, hud->zoom,
+                    vec2(SCREEN_W - UI_EDGE_OFFSET -
+                             ui_text_size(ui, hud->zoom).x,
+                         UI_EDGE_OFFSET));
+}
 
-    // drawing the little squares
-    // indicating which weapon is selected (based on the index).
-    // we draw an empty square for unselected weapon
-    // and a full one for the selected one
-    for (uint8_t i = 0; i < WEAPONS_COUNT; i++) {
-        uint8_t const offset_between_squares = 8;
-        Vector2 const size = scalar_to_vec2(13);
-        Vector2 const pos =
-            vec2(UI_EDGE_OFFSET + size.x * i + offset_between_squares * i,
-                 SCREEN_H - UI_EDGE_OFFSET + 5 - yoffset);
+void ui_update_weapon_name_and_index(ui_t *ui, hud_t const *hud,
+                                     char const *name, int index, int count) {
+    ui_set_text(ui, hud->weapon_name, name);
+    ui_set_position(ui, hud->weapon_name,
+                    vec2(UI_EDGE_OFFSET, SCREEN_H - UI_EDGE_OFFSET -
+                                             ui_text_size(ui, hud->weapon_name).y -
+                                             WEAPON_INFO_YOFFSET));
 
-        if (i == index)
-          DrawRectangleV(pos, size, WHITE);
-        else
-          DrawRectangleLinesEx(rect(pos, size), 1, WHITE);
-    }
+    // the little squares indicating which weapon is selected
+    // (based on the index): empty for the unselected weapons
+    // and full for the selected one
+    for (int i = 0; i < count; i++)
+        ui_set_thickness(ui, hud->first_selector + i, i == index ? 0 : 1);
 }
 
 bool is_mouse_over_rect(Rectangle r) {
     return CheckCollisionPointRec(GetMousePosition(), r);
 }
 
-// draw the continue button and
-// checks whether it's clicked.
+// checks whether the continue button is clicked.
 // the function also checks for
 // mouse hover and highlight the button
 // whether it is
-bool ui_handle_continue_button(Font font) {
+bool ui_handle_continue_button(ui_t *ui, hud_t const *hud) {
+    bool const is_mouse_over =
+        is_mouse_over_rect(ui->widgets[hud->continue_button].rect);
+
+    ui_set_thickness(ui, hud->continue_button, is_mouse_over ? 0 : 1);
+    ui_set_color(ui, hud->continue_caption, is_mouse_over ? BLACK : WHITE);
+
+    return is_mouse_over && IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+}
+
+// declares the hud widgets, the frames only update them
+void init_ctx_hud(ctx_t *ctx) {
+    ui_t *const ui = &ctx->ui;
+    hud_t *const hud = &ctx->hud;
+    if (ctx->is_cpu_only)
+        init_ui_cpu(ui, ctx->font, &ctx->text_cache);
+    else
+        init_ui(ui, ctx->font, &ctx->text_cache);
+
+    // the first frame formats both, whatever the values
+    hud->last_fps = -1;
+    hud->last_zoom_percentage = -1;
+
+    hud->fps = ui_add_text(ui, "", scalar_to_vec2(UI_EDGE_OFFSET),
+                           UI_DEBUG_FONT_SIZE, UI_DEBUG_FONT_SPACING, GRAY);
+    hud->zoom = ui_add_text(ui, "", vec2(0, UI_EDGE_OFFSET),
+                            UI_DEBUG_FONT_SIZE, UI_DEBUG_FONT_SPACING, GRAY);
+    hud->weapon_name =
+        ui_add_text(ui, "", vec2(0, 0), WEAPON_INFO_FONT_SIZE,
+                    UI_DEBUG_FONT_SPACING, WEAPON_NAME_COLOR);
+
+    for (int i = 0; i < ctx->weapons.count; i++) {
+        uint8_t const offset_between_squares = 8;
+        Vector2 const size = scalar_to_vec2(13);
+        Vector2 const pos =
+            vec2(UI_EDGE_OFFSET + size.x * i + offset_between_squares * i,
+                 SCREEN_H - UI_EDGE_OFFSET + 5 - WEAPON_INFO_YOFFSET);
+
+        int const id = ui_add_rect(ui, rect(pos, size), 1, WHITE);
+        if (i == 0)
+            hud->first_selector = id;
+    }
+
     char const *text = "continue";
     float const font_size = 22;
     float const font_spacing = 1;
 
-    Vector2 const text_size = MeasureTextEx(font, text, font_size, font_spacing);
+    Vector2 const text_size = text_cache_measure(&ctx->text_cache, ctx->font,
+                                                 text, font_size, font_spacing);
     Vector2 const text_pos = vec2(SCREEN_W - UI_EDGE_OFFSET - text_size.x - 15,
                                   SCREEN_H - UI_EDGE_OFFSET - text_size.y - 8);
 
@@ -351,30 +894,42 @@ bool ui_handle_continue_button(Font font) {
         vec2(SCREEN_W - UI_EDGE_OFFSET - button_pos.x,
              SCREEN_H - UI_EDGE_OFFSET - button_pos.y);
 
-    Rectangle const button_rect = rect(button_pos, button_size);
-    bool const is_mouse_over = is_mouse_over_rect(button_rect);
-
-    // drawing the button
-    if (is_mouse_over)
-        DrawRectangleV(button_pos, button_size, WHITE);
-    else
-        DrawRectangleLinesEx(button_rect, 1, WHITE);
+    // the button goes first, the caption is drawn over it
+    hud->continue_button =
+        ui_add_rect(ui, rect(button_pos, button_size), 1, WHITE);
+    hud->continue_caption =
+        ui_add_text(ui, text, text_pos, font_size, font_spacing, WHITE);
+}
 
-    // drawing the button's caption
-    DrawTextEx(font, text, text_pos, font_size, font_spacing,
-               is_mouse_over ? BLACK : WHITE);
+bool ctx_update_hud(ctx_t *ctx) {
+    ui_t *const ui = &ctx->ui;
+    hud_t *const hud = &ctx->hud;
+    text_cache_next_frame(&ctx->text_cache);
 
-    return is_mouse_over && IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    ui_update_fps(ui, hud);
+    ui_update_zoom_percentage(ui, hud, ctx->camera.fovy);
+    ui_update_weapon_name_and_index(ui, hud, ctx_cur_weapon_name(ctx),
+                                    ctx->selected_weapon, ctx->weapons.count);
+    return ui_handle_continue_button(ui, hud);
 }
 
 bool ctx_handle_ui(ctx_t *ctx) {
-    Font const font = ctx->font;
+    PROFILE_ZONE("ctx_handle_ui");
 
-    ui_draw_fps(font);
-    ui_draw_zoom_percentage(font, ctx->camera.fovy);
-    ui_draw_weapon_name_and_index(font, ctx_cur_weapon_name(ctx),
-                                  ctx->selected_weapon);
-    bool const is_continue_button_clicked = ui_handle_continue_button(font);
+    bool const is_continue_button_clicked = ctx_update_hud(ctx);
+
+    // a single draw call for the whole hud
+    ui_draw(&ctx->ui);
+
+    // the overlay is immediate mode, the shapes sample
+    // the white texture which reads as fully inside
+    if (profiler_is_enabled()) {
+        BeginShaderMode(ctx->font_shader);
+            profiler_draw_overlay(ctx->font,
+                                  vec2(UI_EDGE_OFFSET,
+                                       UI_EDGE_OFFSET + UI_DEBUG_FONT_SIZE * 2));
+        EndShaderMode();
+    }
 
     return is_continue_button_clicked;
 }
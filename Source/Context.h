@@ -1,5 +1,20 @@
+#ifndef SOURCE_CONTEXT_C
+#define SOURCE_CONTEXT_C
+
 #include "Base.h"
 #include "RayLib.h"
+#include "Jobs.h"
+#include "Loader.h"
+#include "TextureCache.h"
+#include "Catalogue.h"
+#include "Profiler.h"
+#include "PostFx.h"
+#include "TextCache.h"
+#include "FontCache.h"
+#include "FramePacing.h"
+#include "Ui.h"
+#include "Culling.h"
+#include "Wireframe.h"
 
 #define SCREEN_W ((float)1680)
 #define SCREEN_H ((float)1050)
@@ -7,7 +22,7 @@
 
 #define BACKGROUND_COLOR ((Color){15, 15, 15, 255})
 
-#define FONT_RESOLUTION ((int)128)
+#define FONT_PATH ((char const*)"Res/IBM3270.ttf")
 #define FONT_SPACING ((float)1)
 
 #define ZOOM_STEP ((float)0.08)
@@ -19,36 +34,281 @@
 #define ZOOM_MIN ((float)10)
 #define ZOOM_DELTATIME_FACTOR ((float)946)
 
+// the simulation (camera orbit and zoom) advances in fixed ticks
+// whatever the frame rate, the frames draw it interpolated
+// between the last two ticks
+#define SIM_TICK_RATE ((double)120)
+// ticks a frame may catch up, the rest of a longer stall is dropped
+#define SIM_MAX_TICKS_PER_FRAME ((int)8)
+
+#define CAMERA_START_POSITION ((Vector3){-10, 15, -10})
+#define CAMERA_START_FOVY ((float)45)
+// radians per second, as raylib's CAMERA_ORBITAL
+#define CAMERA_ORBIT_SPEED ((float)0.5)
+// redraw the 3d pass only when its scene_key_t changes
+#define RENDER_ON_DEMAND ((bool)true)
+// seconds without input after which, when rendering on demand, the
+// orbit pauses (the camera is in the key), the next input resumes it
+#define ORBIT_IDLE_PAUSE_DELAY ((double)5)
+// zoom_state under which the zoom counts as settled (idle)
+#define ZOOM_IDLE_EPSILON ((float)0.001)
+
 #define UI_EDGE_OFFSET ((float)65)
 #define UI_DEBUG_FONT_SIZE ((float)25)
 #define UI_DEBUG_FONT_SPACING ((float)5)
 #define UI_DEBUG_TEXT_MAX_LENGTH ((int)40)
 
-#define WEAPONS_COUNT ((uint8_t)3)
+#define WEAPONS_MANIFEST_PATH ((char const*)"Res/Weapons.txt")
 #define WEAPON_SWITCH_DIRECTION_NEXT ((int8_t)+1)
 #define WEAPON_SWITCH_DIRECTION_PREVIOUS ((int8_t)-1)
 #define WEAPON_INFO_FONT_SIZE ((float)(UI_DEBUG_FONT_SIZE * 1.4))
+// vertical offset of the weapon name and selectors from the bottom edge
+#define WEAPON_INFO_YOFFSET ((float)19)
 #define WEAPON_NAME_COLOR ((Color){200, 120, 65, 255})
+// bounds drawn around the part of the weapon under the mouse
+#define WEAPON_HOVER_COLOR ((Color){255, 200, 60, 255})
+
+// when streaming, only the selected weapon and its
+// neighbours (in switch order) are kept resident
+#define WEAPON_STREAMING ((bool)true)
+#define WEAPON_STREAMING_NEIGHBOURS ((int)1)
+#define WEAPON_STREAMING_BUDGET ((size_t)256 * 1024 * 1024)
+
+// when streaming, weapon textures come in with their levels
+// up to this size, finer ones are loaded when the selected weapon
+// covers enough pixels and dropped when it doesn't anymore
+#define TEXTURE_STREAMING ((bool)true)
+#define TEXTURE_STREAMING_INITIAL_SIZE ((int)256)
+// texels wanted along a side per pixel the weapon covers,
+// more than 1 since a texture atlas spans a model only partially
+#define TEXTURE_STREAMING_TEXELS_PER_PIXEL ((float)2)
 
+typedef enum {
+    WEAPON_UNLOADED,
+    // decoding on the workers
+    WEAPON_LOADING,
+    WEAPON_RESIDENT
+} weapon_residency_t;
+
+// mip residency of a weapon texture
+typedef struct {
+    // full chain of the cache, zeroed when the texture isn't streamed
+    texture_cache_header_t header;
+    // top level of the uploaded texture
+    int resident_level;
+    // top level being read by the workers, -1 when idle
+    int loading_level;
+    Image pending;
+    job_group_t group;
+} weapon_texture_stream_t;
+
+// every array is sized by count, one element per catalogue entry
 typedef struct {
-    Model models[WEAPONS_COUNT];
-    float scales[WEAPONS_COUNT];
-    char const* names[WEAPONS_COUNT];
+    int count;
+    weapon_desc_t const* descs;
+    Model* models;
+    // levels of detail of each resident model
+    model_lods_t* lods;
+    // ray queries (picking) against each resident model
+    model_bvh_t* bvhs;
+    float* scales;
+    char const** names;
+
+    weapon_residency_t* residencies;
+    // in-flight loads, only valid while WEAPON_LOADING
+    weapon_load_t* loads;
+    job_group_t* load_groups;
+    // estimated cpu + gpu bytes of each resident weapon
+    size_t* sizes;
+    // texture mip residency of each resident weapon
+    weapon_texture_stream_t (*texture_streams)[WEAPON_TEXTURE_COUNT];
 } weapons_t;
 
+// the actions of a frame, polled from the
+// keyboard or fed by a script (benchmarks)
+typedef struct {
+    bool zoom_in;
+    bool zoom_out;
+    bool switch_next_weapon;
+    bool switch_previous_weapon;
+    bool toggle_profiler;
+    bool dump_trace;
+    bool toggle_orbit;
+} input_t;
+
+// what the fixed ticks advance
+typedef struct {
+    float fovy;
+    // smoothed zoom direction, towards ZOOM_IN_TARGET,
+    // ZOOM_OUT_TARGET or ZOOM_STOP_TARGET
+    float zoom_state;
+    // radians orbited around the target since the start
+    float orbit_angle;
+    bool is_orbiting;
+} sim_state_t;
+
+// what the 3d pass depends on, a frame with the
+// same key as the last one reuses its resolved scene
+typedef struct {
+    Camera3D camera;
+    int selected_weapon;
+    bool is_weapon_resident;
+    int hovered_mesh;
+    // the texture ids of the weapon's materials,
+    // changing when streaming swaps a mip chain
+    uint32_t textures_hash;
+} scene_key_t;
+
+// cpu time of each phase of the last frame, in seconds
+typedef struct {
+    double update;
+    double draw_3d;
+    double ui;
+    double present;
+} frame_timings_t;
+
+// ids of the hud widgets in ctx_t.ui
+typedef struct {
+    int fps;
+    int zoom;
+    int weapon_name;
+    // one square per weapon, consecutive ids
+    int first_selector;
+    int continue_button;
+    int continue_caption;
+
+    // values the texts were last formatted with, -1 for none
+    int last_fps;
+    int last_zoom_percentage;
+    char fps_text[UI_DEBUG_TEXT_MAX_LENGTH];
+    char zoom_text[UI_DEBUG_TEXT_MAX_LENGTH];
+} hud_t;
+
 // context for the ctx
 typedef struct {
+    // distance field font, drawn at any size by the hud's shader and,
+    // for the immediate mode profiler overlay, through font_shader
     Font font;
-    // RenderTexture2D screen_shader_target;
-    // Shader shader;
+    Shader font_shader;
+    // layouts of the ui strings, measured and tessellated once
+    text_cache_t text_cache;
+    // the hud, declared once and drawn in a single batch
+    ui_t ui;
+    hud_t hud;
+    // offscreen 3d pass and its post-processing
+    post_fx_t post_fx;
+    // draws the solid/wire crossfade in one pass
+    wireframe_shader_t wireframe_shader;
 
+    catalogue_t catalogue;
     weapons_t weapons;
     // index to ctx_t.weapons
-    uint8_t selected_weapon;
+    int selected_weapon;
+    // mesh of the selected weapon under the mouse, -1 for none
+    int hovered_mesh;
+    // inverse draw transform of the weapon the picking rays are
+    // brought into model space for, -1 for none
+    Matrix hover_inverse;
+    int hover_inverse_weapon;
+    // crossfade meshes of the selected weapon, built when it first
+    // enters the fade band and released once it's deselected
+    model_wireframe_t wireframe;
+    // weapon the wireframe was built for, -1 for none
+    int wireframe_weapon;
 
+    // drawn camera, interpolated between the last two ticks
     Camera3D camera;
+
+    // the last two ticks of the simulation
+    sim_state_t sim;
+    sim_state_t previous_sim;
+    // seconds of frame time not simulated yet
+    double sim_accumulator;
+    // seconds per tick
+    double sim_tick;
+    // frame rate of ctx_loop, independent of the tick rate
+    frame_pacer_t pacer;
+
+    // meshes of the selected weapon in the camera's frustum,
+    // flagged by the 3d pass and reused by the emission pass
+    bool* visible_meshes;
+    int visible_meshes_capacity;
+    // what the culling of the last 3d pass kept and skipped
+    cull_stats_t cull_stats;
+
+    // the 3d pass is skipped while its key doesn't change
+    bool render_on_demand;
+    scene_key_t scene_key;
+    // post_fx holds a scene resolved with scene_key
+    bool is_scene_valid;
+    // 3d passes drawn and skipped (scene reused) since init
+    int64_t drawn_scenes;
+    int64_t reused_scenes;
+    // GetTime of the last frame with input
+    double last_input_time;
+    // the orbit was paused for lack of input, not by the user
+    bool is_orbit_idle_paused;
+
+    // made by init_ctx_cpu: nothing is uploaded, the frames
+    // can only be drawn by the soft renderer (soft_frame_t)
+    bool is_cpu_only;
+
+    // when set, the frames are presented into it instead of the
+    // window, which isn't touched (headless runs, see Headless.h)
+    RenderTexture2D* offscreen_target;
+
+    input_t input;
+    // when set, ctx->input is left as is instead of polled
+    bool is_input_scripted;
+    frame_timings_t timings;
+
+    // workers for asset decoding
+    jobs_t jobs;
+
+    // weapon streaming settings
+    bool weapon_streaming;
+    int weapon_streaming_neighbours;
+    // bytes the resident weapons may take before
+    // the ones farthest from the selection get evicted
+    size_t weapon_streaming_budget;
+
+    // texture streaming settings
+    bool texture_streaming;
+    int texture_streaming_initial_size;
 } ctx_t;
 
 void init_ctx(ctx_t* ctx);
+// a ctx without gl (no window or context needed), loaded from the
+// caches only: the font's atlas and the meshes stay cpu side, there
+// are no textures, shaders nor post-processing
+void init_ctx_cpu(ctx_t* ctx);
+void deinit_ctx(ctx_t* ctx);
+// the size of the presented frame, the window's or, without a
+// window (headless gl contexts), the size the targets are made at
+int ctx_screen_width();
+int ctx_screen_height();
 void ctx_exit(ctx_t* ctx);
-void ctx_loop(ctx_t* ctx);
\ No newline at end of file
+void ctx_loop(ctx_t* ctx);
+// a single frame: input, update, drawing
+void ctx_internal_update(ctx_t* ctx);
+
+// the parts of a frame other renderers (soft_frame_t) reuse
+void ctx_simulate(ctx_t* ctx, double frame_time);
+// the camera between two ticks, alpha going from previous (0) to current (1)
+Camera3D sim_camera(sim_state_t const* previous, sim_state_t const* current,
+                    float alpha);
+void ctx_update(ctx_t* ctx);
+// the hud widgets of the frame, true when continue was clicked
+bool ctx_update_hud(ctx_t* ctx);
+Model ctx_cur_weapon(ctx_t* ctx);
+float ctx_cur_weapon_scale(ctx_t* ctx);
+// alpha of the solid model in the solid/wire crossfade
+uint8_t ctx_cur_weapon_alpha(ctx_t* ctx);
+// the crossfade meshes of the current weapon, built on the first call
+model_wireframe_t const* ctx_cur_weapon_wireframe(ctx_t* ctx);
+
+// rewrites the mesh and texture caches of every weapon
+// (needs a gl context, the models get uploaded while parsed)
+void bake_ctx_weapons();
+
+#endif
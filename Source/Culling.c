@@ -0,0 +1,85 @@
+#include "Culling.h"
+
+Matrix model_draw_transform(Model model, Vector3 pos, float scale) {
+    return MatrixMultiply(model.transform,
+                          MatrixMultiply(MatrixScale(scale, scale, scale),
+                                         MatrixTranslate(pos.x, pos.y, pos.z)));
+}
+
+frustum_t frustum_from_matrix(Matrix m) {
+    // rows of the matrix, as Vector3Transform applies it
+    Vector4 const x = {m.m0, m.m4, m.m8, m.m12};
+    Vector4 const y = {m.m1, m.m5, m.m9, m.m13};
+    Vector4 const z = {m.m2, m.m6, m.m10, m.m14};
+    Vector4 const w = {m.m3, m.m7, m.m11, m.m15};
+
+    // -w <= x, y, z <= w in clip space
+    frustum_t frustum = {.planes = {
+        {w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w},
+        {w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w},
+        {w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w},
+        {w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w},
+        {w.x + z.x, w.y + z.y, w.z + z.z, w.w + z.w},
+        {w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w}}};
+
+    return frustum;
+}
+
+bool frustum_overlaps_box(frustum_t const* frustum, BoundingBox box) {
+    for (int i = 0; i < 6; i++) {
+        Vector4 const p = frustum->planes[i];
+
+        // the corner farthest along the plane's normal
+        Vector3 const corner = vec3(p.x >= 0 ? box.max.x : box.min.x,
+                                    p.y >= 0 ? box.max.y : box.min.y,
+                                    p.z >= 0 ? box.max.z : box.min.z);
+
+        if (p.x * corner.x + p.y * corner.y + p.z * corner.z + p.w < 0)
+            return false;
+    }
+
+    return true;
+}
+
+Matrix rl_current_mvp(Matrix transform) {
+    // DrawMesh multiplies the transform into the modelview
+    Matrix const model_view = MatrixMultiply(transform, rlGetMatrixModelview());
+    return MatrixMultiply(model_view, rlGetMatrixProjection());
+}
+
+void cull_meshes(frustum_t const* frustum, Mesh const* meshes,
+                 BoundingBox const* bounds, int count, bool* visible,
+                 cull_stats_t* stats) {
+    for (int i = 0; i < count; i++) {
+        visible[i] = frustum_overlaps_box(frustum, bounds[i]);
+
+        if (visible[i]) {
+            stats->drawn_meshes++;
+            stats->drawn_triangles += meshes[i].triangleCount;
+        } else {
+            stats->culled_meshes++;
+            stats->culled_triangles += meshes[i].triangleCount;
+        }
+    }
+}
+
+void draw_model_visible(Model model, bool const* visible, Vector3 pos,
+                        float scale, Color tint) {
+    Matrix const transform = model_draw_transform(model, pos, scale);
+
+    for (int i = 0; i < model.meshCount; i++) {
+        if (visible != NULL && !visible[i])
+            continue;
+
+        // tinted for this draw only, as DrawModel does
+        MaterialMap* const diffuse =
+            &model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE];
+        Color const color = diffuse->color;
+
+        diffuse->color = (Color){color.r * tint.r / 255, color.g * tint.g / 255,
+                                 color.b * tint.b / 255, color.a * tint.a / 255};
+        DrawMesh(model.meshes[i], model.materials[model.meshMaterial[i]],
+                 transform);
+        diffuse->color = color;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef SOURCE_CULLING_C
+#define SOURCE_CULLING_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// the view volume of a matrix, a * x + b * y + c * z + d >= 0
+// inside every plane (left, right, bottom, top, near, far)
+typedef struct {
+    Vector4 planes[6];
+} frustum_t;
+
+// what the culling passes of a frame kept and skipped
+typedef struct {
+    int drawn_meshes;
+    int culled_meshes;
+    int64_t drawn_triangles;
+    int64_t culled_triangles;
+} cull_stats_t;
+
+// the transform DrawModel draws the model with
+Matrix model_draw_transform(Model model, Vector3 pos, float scale);
+
+// the volume in the input space of the matrix, model space
+// for a model-view-projection
+frustum_t frustum_from_matrix(Matrix m);
+
+// false only when the box is entirely outside a plane
+// (conservative, boxes near a corner may pass)
+bool frustum_overlaps_box(frustum_t const* frustum, BoundingBox box);
+
+// the model-view-projection rlgl draws the transform with,
+// inside a BeginMode3D
+Matrix rl_current_mvp(Matrix transform);
+
+// flags the meshes whose bounds overlap the frustum,
+// counting them into stats
+void cull_meshes(frustum_t const* frustum, Mesh const* meshes,
+                 BoundingBox const* bounds, int count, bool* visible,
+                 cull_stats_t* stats);
+
+// DrawModel skipping the meshes not flagged visible
+// (null draws every mesh)
+void draw_model_visible(Model model, bool const* visible, Vector3 pos,
+                        float scale, Color tint);
+
+#endif
@@ -0,0 +1,242 @@
+#include "FontCache.h"
+#include "MeshCache.h"
+#include "Profiler.h"
+#include <string.h>
+
+void font_cache_path(char const* font_path, char* buf, int buf_size) {
+    char const* ext = strrchr(font_path, '.');
+    int const stem_length = ext != NULL ? (int)(ext - font_path)
+                                        : (int)strlen(font_path);
+
+    snprintf(buf, buf_size, "%.*s%s", stem_length, font_path,
+             FONT_CACHE_EXTENSION);
+}
+
+int64_t font_cache_blob_size(font_cache_header_t const* header) {
+    return (int64_t)sizeof(*header) +
+           (int64_t)header->glyph_count * (int64_t)sizeof(font_cache_glyph_t) +
+           (int64_t)header->atlas_width * header->atlas_height;
+}
+
+bool font_cache_is_header_valid(font_cache_header_t const* header,
+                                char const* font_path, int64_t file_size) {
+    return header->magic == FONT_CACHE_MAGIC &&
+           header->version == FONT_CACHE_VERSION &&
+           header->source_mod_time == (int64_t)GetFileModTime(font_path) &&
+           header->source_size == (int64_t)GetFileLength(font_path) &&
+           header->base_size > 0 && header->glyph_count > 0 &&
+           header->glyph_padding >= 0 && header->atlas_width > 0 &&
+           header->atlas_height > 0 &&
+           font_cache_blob_size(header) == file_size;
+}
+
+// uploads the distance atlas, the red channel being the distance
+Texture2D font_atlas_upload(Image atlas) {
+    Texture2D const texture = LoadTextureFromImage(atlas);
+    // the distance is interpolated, not the coverage
+    SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+
+    return texture;
+}
+
+// the font without its texture and a copy of the atlas bytes
+bool font_cache_load(char const* font_path, Font* font, Image* atlas) {
+    PROFILE_ZONE("font_cache_load");
+
+    if (!is_host_little_endian())
+        return false;
+
+    char cache_path[FONT_CACHE_PATH_MAX_LENGTH];
+    font_cache_path(font_path, cache_path, sizeof(cache_path));
+
+    if (!FileExists(cache_path))
+        return false;
+
+    unsigned int size = 0;
+    uint8_t* const blob = LoadFileData(cache_path, &size);
+    font_cache_header_t header = {0};
+
+    if (blob != NULL && size >= sizeof(header))
+        memcpy(&header, blob, sizeof(header));
+
+    if (!font_cache_is_header_valid(&header, font_path, (int64_t)size)) {
+        TraceLog(LOG_WARNING, "FONTCACHE: [%s] Stale or malformed cache",
+                 cache_path);
+        UnloadFileData(blob);
+        return false;
+    }
+
+    font_cache_glyph_t const* const glyphs =
+        (font_cache_glyph_t const*)(blob + sizeof(header));
+    int const pixels = header.atlas_width * header.atlas_height;
+
+    *atlas = (Image){.data = RL_MALLOC(pixels),
+                     .width = header.atlas_width,
+                     .height = header.atlas_height,
+                     .mipmaps = 1,
+                     .format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE};
+    memcpy(atlas->data, glyphs + header.glyph_count, pixels);
+
+    *font = (Font){.baseSize = header.base_size,
+                   .glyphCount = header.glyph_count,
+                   .glyphPadding = header.glyph_padding};
+    font->glyphs = RL_CALLOC(header.glyph_count, sizeof(GlyphInfo));
+    font->recs = RL_MALLOC(sizeof(Rectangle) * header.glyph_count);
+
+    for (int i = 0; i < header.glyph_count; i++) {
+        font->glyphs[i] = (GlyphInfo){.value = glyphs[i].codepoint,
+                                      .offsetX = glyphs[i].offset_x,
+                                      .offsetY = glyphs[i].offset_y,
+                                      .advanceX = glyphs[i].advance_x};
+        font->recs[i] = glyphs[i].rec;
+    }
+
+    UnloadFileData(blob);
+
+    return true;
+}
+
+bool font_cache_save(char const* font_path, Font font, Image atlas) {
+    if (!is_host_little_endian())
+        return false;
+
+    char cache_path[FONT_CACHE_PATH_MAX_LENGTH];
+    font_cache_path(font_path, cache_path, sizeof(cache_path));
+
+    font_cache_header_t const header = {
+        .magic = FONT_CACHE_MAGIC,
+        .version = FONT_CACHE_VERSION,
+        .source_mod_time = (int64_t)GetFileModTime(font_path),
+        .source_size = (int64_t)GetFileLength(font_path),
+        .base_size = font.baseSize,
+        .glyph_count = font.glyphCount,
+        .glyph_padding = font.glyphPadding,
+        .atlas_width = atlas.width,
+        .atlas_height = atlas.height};
+
+    int64_t const size = font_cache_blob_size(&header);
+    uint8_t* const blob = RL_MALLOC(size);
+    memcpy(blob, &header, sizeof(header));
+
+    font_cache_glyph_t* const glyphs =
+        (font_cache_glyph_t*)(blob + sizeof(header));
+    for (int i = 0; i < font.glyphCount; i++)
+        glyphs[i] = (font_cache_glyph_t){.codepoint = font.glyphs[i].value,
+                                         .offset_x = font.glyphs[i].offsetX,
+                                         .offset_y = font.glyphs[i].offsetY,
+                                         .advance_x = font.glyphs[i].advanceX,
+                                         .rec = font.recs[i]};
+
+    memcpy(glyphs + font.glyphCount, atlas.data,
+           (size_t)atlas.width * atlas.height);
+
+    bool const ok = SaveFileData(cache_path, blob, (unsigned int)size);
+    RL_FREE(blob);
+
+    return ok;
+}
+
+// renders the distance field of every glyph and packs them, the font
+// has no texture yet and the atlas holds one distance byte per pixel
+Font bake_font_data(char const* font_path, Image* atlas) {
+    Font font = {0};
+    *atlas = (Image){0};
+
+    unsigned int size = 0;
+    uint8_t* const data = LoadFileData(font_path, &size);
+    if (data == NULL)
+        return font;
+
+    font.baseSize = FONT_SDF_BASE_SIZE;
+    font.glyphCount = FONT_SDF_GLYPH_COUNT;
+    // the glyph images already carry the distance falloff around them
+    font.glyphPadding = 0;
+    font.glyphs = LoadFontData(data, (int)size, FONT_SDF_BASE_SIZE, NULL,
+                               FONT_SDF_GLYPH_COUNT, FONT_SDF);
+    UnloadFileData(data);
+
+    if (font.glyphs == NULL)
+        return (Font){0};
+
+    // raylib packs the atlas as gray + alpha, with the
+    // glyph values in alpha and white in gray
+    Image const packed = GenImageFontAtlas(font.glyphs, &font.recs,
+                                           font.glyphCount, font.baseSize,
+                                           font.glyphPadding, 1);
+    uint8_t const* const texels = packed.data;
+    int const pixels = packed.width * packed.height;
+
+    *atlas = (Image){.data = RL_MALLOC(pixels),
+                     .width = packed.width,
+                     .height = packed.height,
+                     .mipmaps = 1,
+                     .format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE};
+    for (int i = 0; i < pixels; i++)
+        ((uint8_t*)atlas->data)[i] = texels[i * 2 + 1];
+
+    UnloadImage(packed);
+    return font;
+}
+
+// renders the font, then rewrites the cache
+Font bake_font(char const* font_path, Image* atlas, bool* saved) {
+    Font const font = bake_font_data(font_path, atlas);
+    *saved = false;
+
+    if (font.glyphs == NULL) {
+        TraceLog(LOG_WARNING, "FONTCACHE: [%s] Failed to load", font_path);
+        return font;
+    }
+
+    *saved = font_cache_save(font_path, font, *atlas);
+    if (*saved)
+        TraceLog(LOG_INFO, "FONTCACHE: [%s] Baked %d glyphs at %dpx, %dx%d atlas",
+                 font_path, font.glyphCount, font.baseSize, atlas->width,
+                 atlas->height);
+    else
+        TraceLog(LOG_WARNING, "FONTCACHE: [%s] Failed to bake", font_path);
+
+    return font;
+}
+
+Font load_font_sdf_cpu(char const* font_path, Image* atlas,
+                       bool* from_cache) {
+    Font font;
+    bool const cached = font_cache_load(font_path, &font, atlas);
+
+    if (from_cache != NULL)
+        *from_cache = cached;
+
+    if (cached)
+        return font;
+
+    // falling back to the source file, the font is
+    // used right away even if the cache can't be saved
+    bool saved;
+    return bake_font(font_path, atlas, &saved);
+}
+
+Font load_font_sdf(char const* font_path, bool* from_cache) {
+    Image atlas;
+    Font font = load_font_sdf_cpu(font_path, &atlas, from_cache);
+
+    if (font.glyphs == NULL)
+        return GetFontDefault();
+
+    font.texture = font_atlas_upload(atlas);
+    UnloadImage(atlas);
+
+    return font;
+}
+
+bool bake_font_sdf(char const* font_path) {
+    Image atlas;
+    bool saved;
+    Font const font = bake_font(font_path, &atlas, &saved);
+
+    UnloadFontData(font.glyphs, font.glyphCount);
+    RL_FREE(font.recs);
+    UnloadImage(atlas);
+
+    return saved;
+}
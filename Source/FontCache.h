@@ -0,0 +1,68 @@
+#ifndef SOURCE_FONTCACHE_C
+#define SOURCE_FONTCACHE_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+#define FONT_CACHE_MAGIC ((uint32_t)0x43464452) // "RDFC" little-endian
+#define FONT_CACHE_VERSION ((uint32_t)1)
+#define FONT_CACHE_EXTENSION ((char const*)".fcache")
+#define FONT_CACHE_PATH_MAX_LENGTH ((int)256)
+
+// size the glyph distance fields are rendered at, the text is
+// drawn crisp at any size from this single atlas
+#define FONT_SDF_BASE_SIZE ((int)48)
+// printable ascii
+#define FONT_SDF_GLYPH_COUNT ((int)95)
+// draws text from a distance field atlas
+#define FONT_SDF_SHADER_PATH ((char const*)"Res/Shaders/Sdf.fs")
+
+// layout of the blob, every field is little-endian:
+//   font_cache_header_t
+//   glyph_count * font_cache_glyph_t
+//   atlas_width * atlas_height bytes of distances
+//   (0.5 on the outline, growing inside)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    // source font identity, a mismatch means the cache is stale
+    int64_t source_mod_time;
+    int64_t source_size;
+    int32_t base_size;
+    int32_t glyph_count;
+    int32_t glyph_padding;
+    int32_t atlas_width;
+    int32_t atlas_height;
+} font_cache_header_t;
+
+typedef struct {
+    int32_t codepoint;
+    int32_t offset_x;
+    int32_t offset_y;
+    int32_t advance_x;
+    // rectangle of the glyph in the atlas
+    Rectangle rec;
+} font_cache_glyph_t;
+
+// writes the cache path of a font (same name, cache extension) into buf
+void font_cache_path(char const* font_path, char* buf, int buf_size);
+
+// loads the sdf font and its atlas (one distance byte per pixel)
+// from the cache when fresh, otherwise renders the distance fields
+// from the source and rebakes the cache. the font has no texture,
+// its glyphs are null when it failed to load.
+// from_cache (optional) reports which path was taken.
+// cpu side only, for renderers without gl (soft_frame_t)
+Font load_font_sdf_cpu(char const* font_path, Image* atlas,
+                       bool* from_cache);
+
+// loads the sdf font from the cache when fresh, otherwise renders
+// the distance fields from the source and rebakes the cache.
+// from_cache (optional) reports which path was taken.
+// needs a gl context, the atlas gets uploaded
+Font load_font_sdf(char const* font_path, bool* from_cache);
+
+// renders the distance fields of the source, always rewriting the cache
+bool bake_font_sdf(char const* font_path);
+
+#endif
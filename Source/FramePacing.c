@@ -0,0 +1,64 @@
+#include "FramePacing.h"
+#include "Profiler.h"
+#include <math.h>
+
+void init_frame_pacer(frame_pacer_t* pacer, int target_rate, int idle_rate,
+                      double idle_delay) {
+    if (target_rate <= 0)
+        target_rate = GetMonitorRefreshRate(GetCurrentMonitor());
+
+    if (target_rate <= 0)
+        target_rate = FRAME_PACING_FALLBACK_RATE;
+
+    *pacer = (frame_pacer_t){.target_rate = target_rate,
+                             .idle_rate = idle_rate,
+                             .idle_delay = idle_delay,
+                             .last_activity = GetTime(),
+                             .next_frame = GetTime(),
+                             .oversleep = FRAME_PACING_SLEEP_STEP,
+                             .is_idle = false};
+}
+
+void frame_pacer_mark_activity(frame_pacer_t* pacer) {
+    pacer->last_activity = GetTime();
+}
+
+void frame_pacer_wait_until(frame_pacer_t* pacer, double deadline) {
+    // coarse sleeps, as long as one more can't overshoot
+    for (;;) {
+        double const now = GetTime();
+
+        if (deadline - now <= FRAME_PACING_SLEEP_STEP + pacer->oversleep +
+                                  FRAME_PACING_SPIN_MARGIN)
+            break;
+
+        WaitTime(FRAME_PACING_SLEEP_STEP);
+
+        double const slept = GetTime() - now;
+        pacer->oversleep = fmax(slept - FRAME_PACING_SLEEP_STEP,
+                                pacer->oversleep * FRAME_PACING_OVERSLEEP_DECAY);
+    }
+
+    // the rest is too short for the os scheduler
+    while (GetTime() < deadline) {
+    }
+}
+
+void frame_pacer_wait(frame_pacer_t* pacer) {
+    PROFILE_ZONE("frame_pacer_wait");
+
+    double const now = GetTime();
+    pacer->is_idle = now - pacer->last_activity >= pacer->idle_delay;
+
+    int const rate = pacer->is_idle ? pacer->idle_rate : pacer->target_rate;
+    pacer->next_frame += 1.0 / rate;
+
+    // a late frame moves the schedule instead of
+    // making the next ones catch up back to back
+    if (pacer->next_frame < now) {
+        pacer->next_frame = now;
+        return;
+    }
+
+    frame_pacer_wait_until(pacer, pacer->next_frame);
+}
@@ -0,0 +1,54 @@
+#ifndef SOURCE_FRAMEPACING_C
+#define SOURCE_FRAMEPACING_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// frames per second while in use, 0 for the monitor's refresh rate
+#define FRAME_PACING_TARGET_RATE ((int)0)
+// used when the refresh rate can't be queried
+#define FRAME_PACING_FALLBACK_RATE ((int)60)
+// frames per second once idle, when the camera is static
+// (no orbit, no zoom) and nothing is loading
+#define FRAME_PACING_IDLE_RATE ((int)20)
+// seconds without activity before going idle
+#define FRAME_PACING_IDLE_DELAY ((double)3)
+// coarse sleeps are this long, the rest of the wait is spun
+#define FRAME_PACING_SLEEP_STEP ((double)0.001)
+// margin kept for spinning on top of the worst recent oversleep
+#define FRAME_PACING_SPIN_MARGIN ((double)0.0002)
+// per sleep decay of the worst oversleep, so that a single
+// descheduling doesn't make the waits spin forever
+#define FRAME_PACING_OVERSLEEP_DECAY ((double)0.99)
+
+// paces the frames of ctx_loop: a full rate while in use
+// and a low one once idle, waiting with a hybrid sleep
+// (coarse os sleeps, then spinning up to the deadline)
+typedef struct {
+    int target_rate;
+    int idle_rate;
+    double idle_delay;
+
+    // GetTime of the last frame with activity
+    double last_activity;
+    // GetTime the next frame should start at
+    double next_frame;
+    // worst recent time a coarse sleep took past its length
+    double oversleep;
+    bool is_idle;
+} frame_pacer_t;
+
+// target_rate 0 picks the current monitor's refresh rate
+void init_frame_pacer(frame_pacer_t* pacer, int target_rate, int idle_rate,
+                      double idle_delay);
+
+// keeps the full rate for at least idle_delay more seconds
+void frame_pacer_mark_activity(frame_pacer_t* pacer);
+
+// waits for the start of the next frame, to call once per frame
+void frame_pacer_wait(frame_pacer_t* pacer);
+
+// sleeps then spins until GetTime reaches deadline
+void frame_pacer_wait_until(frame_pacer_t* pacer, double deadline);
+
+#endif
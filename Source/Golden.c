@@ -0,0 +1,278 @@
+#include "Golden.h"
+#include "SoftFrame.h"
+#include "Streaming.h"
+#include "TextureStreaming.h"
+#include "Headless.h"
+#include <math.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #define golden_mkdir(path) _mkdir(path)
+#else
+    #include <sys/stat.h>
+    #define golden_mkdir(path) mkdir(path, 0755)
+#endif
+
+// creates the directory and its missing parents, false on failure
+bool golden_make_dirs(char const* path) {
+    char partial[GOLDEN_PATH_MAX_LENGTH];
+    snprintf(partial, sizeof(partial), "%s", path);
+    if (partial[0] == '\0')
+        return false;
+
+    for (char* c = partial + 1;; c++) {
+        bool const is_end = *c == '\0';
+        if (!is_end && *c != '/' && *c != '\\')
+            continue;
+
+        char const separator = *c;
+        *c = '\0';
+
+        if (!DirectoryExists(partial) && golden_mkdir(partial) != 0)
+            return false;
+
+        if (is_end)
+            return true;
+
+        *c = separator;
+    }
+}
+
+// the start pose, an orbited mid zoom, and the deep
+// zoom where the solid model fades into its wireframe
+golden_pose_t const GOLDEN_POSES[] = {
+    {.name = "start", .orbit_angle = 0, .fovy = CAMERA_START_FOVY},
+    {.name = "zoom", .orbit_angle = 2.1, .fovy = 25},
+    {.name = "wire", .orbit_angle = 4.2, .fovy = 11},
+};
+
+#define GOLDEN_POSE_COUNT \
+    ((int)(sizeof(GOLDEN_POSES) / sizeof(GOLDEN_POSES[0])))
+
+// the weapon loaded synchronously, the streaming
+// finishing its load from the workers
+void golden_select_weapon(ctx_t* ctx, int weapon) {
+    ctx->selected_weapon = weapon;
+
+    while (!ctx_is_weapon_resident(ctx, weapon)) {
+        ctx_update_weapon_streaming(ctx);
+        WaitTime(0.001);
+    }
+}
+
+void golden_set_pose(ctx_t* ctx, golden_pose_t const* pose) {
+    ctx->sim = (sim_state_t){.fovy = pose->fovy,
+                             .orbit_angle = pose->orbit_angle};
+    ctx->previous_sim = ctx->sim;
+    ctx->camera = sim_camera(&ctx->previous_sim, &ctx->sim, 1);
+}
+
+bool golden_is_texture_streaming(ctx_t* ctx) {
+    for (int i = 0; i < ctx->weapons.count; i++)
+        for (int j = 0; j < WEAPON_TEXTURE_COUNT; j++)
+            if (ctx->weapons.texture_streams[i][j].loading_level >= 0)
+                return true;
+
+    return false;
+}
+
+// the texture levels the pose wants, read and uploaded before the
+// frame is drawn rather than whenever the workers are done
+void golden_settle_textures(ctx_t* ctx) {
+    ctx_update_texture_streaming(ctx);
+
+    while (golden_is_texture_streaming(ctx)) {
+        WaitTime(0.001);
+        // finishing a read, then queueing the next one if still wanted
+        ctx_update_texture_streaming(ctx);
+        ctx_update_texture_streaming(ctx);
+    }
+}
+
+// pixelmatch's perceived distance of two colors, in yiq space,
+// normalized to 0 to 1
+float golden_color_distance(Color a, Color b) {
+    float const dr = a.r - b.r;
+    float const dg = a.g - b.g;
+    float const db = a.b - b.b;
+
+    float const y = dr * 0.29889531f + dg * 0.58662247f + db * 0.11448223f;
+    float const i = dr * 0.59597799f - dg * 0.27417610f - db * 0.32180189f;
+    float const q = dr * 0.21147017f - dg * 0.52261711f + db * 0.31114694f;
+
+    // 35215 is the distance of black to white
+    return sqrtf((0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q) /
+                 35215);
+}
+
+// different pixels of two same sized rgba8 images, from the
+// threshold. diff (optional) receives the reference
+// faded to gray with the differences in red
+int golden_compare(Image actual, Image reference, float threshold,
+                   Image* diff) {
+    Color const* const a = actual.data;
+    Color const* const r = reference.data;
+    Color* const d = diff != NULL ? diff->data : NULL;
+    int const count = actual.width * actual.height;
+    int different = 0;
+
+    for (int i = 0; i < count; i++) {
+        bool const is_different =
+            golden_color_distance(a[i], r[i]) > threshold;
+        different += is_different;
+
+        if (d == NULL)
+            continue;
+
+        uint8_t const gray =
+            (uint8_t)(255 - (255 - (r[i].r + r[i].g + r[i].b) / 3) / 4);
+        d[i] = is_different ? RED : color(gray, gray, gray, 255);
+    }
+
+    return different;
+}
+
+// compares the frame to its reference, or rewrites the reference
+bool golden_check(Image frame, char const* name, bool update,
+                  float pixel_threshold, float max_diff_ratio) {
+    char reference_path[GOLDEN_PATH_MAX_LENGTH];
+    snprintf(reference_path, sizeof(reference_path), "%s/%s.png",
+             GOLDEN_REFERENCE_DIR, name);
+
+    if (update) {
+        bool const ok = ExportImage(frame, reference_path);
+        printf("%-24s %s\n", name, ok ? "updated" : "FAILED to write");
+        return ok;
+    }
+
+    Image reference = LoadImage(reference_path);
+    bool passed = false;
+    char const* outcome = "MISSING (run --golden update)";
+
+    if (reference.data != NULL) {
+        ImageFormat(&reference, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        outcome = "SIZE MISMATCH";
+    }
+
+    if (reference.data != NULL && reference.width == frame.width &&
+        reference.height == frame.height) {
+        Image diff = ImageCopy(frame);
+        int const different =
+            golden_compare(frame, reference, pixel_threshold, &diff);
+        float const ratio = (float)different / (frame.width * frame.height);
+
+        passed = ratio <= max_diff_ratio;
+        printf("%-24s %8d px %8.4f%% %s\n", name, different, ratio * 100,
+               passed ? "ok" : "FAILED");
+
+        if (!passed) {
+            char diff_path[GOLDEN_PATH_MAX_LENGTH];
+            snprintf(diff_path, sizeof(diff_path), "%s/%s.diff.png",
+                     GOLDEN_OUTPUT_DIR, name);
+            ExportImage(diff, diff_path);
+        }
+
+        UnloadImage(diff);
+    } else {
+        printf("%-24s %s\n", name, outcome);
+    }
+
+    if (!passed) {
+        char frame_path[GOLDEN_PATH_MAX_LENGTH];
+        snprintf(frame_path, sizeof(frame_path), "%s/%s.png",
+                 GOLDEN_OUTPUT_DIR, name);
+        ExportImage(frame, frame_path);
+    }
+
+    UnloadImage(reference);
+    return passed;
+}
+
+int run_golden(bool update) {
+    SetTraceLogLevel(LOG_WARNING);
+
+    // without references every case would only fail
+    if (!update && !DirectoryExists(GOLDEN_REFERENCE_DIR)) {
+        printf("no references in %s, run --golden update to create them "
+               "from a known good build\n",
+               GOLDEN_REFERENCE_DIR);
+        return 1;
+    }
+
+    char const* const output_dir =
+        update ? GOLDEN_REFERENCE_DIR : GOLDEN_OUTPUT_DIR;
+    if (!golden_make_dirs(output_dir)) {
+        printf("failed to create %s, the frames can't be written\n",
+               output_dir);
+        return 1;
+    }
+
+    headless_gl_t gl;
+    if (!init_headless_gl(&gl)) {
+        printf("no gl context, the goldens can't run\n");
+        return 1;
+    }
+
+    ctx_t ctx;
+    init_ctx(&ctx);
+    ctx.is_input_scripted = true;
+    ctx.input = (input_t){0};
+    // every case draws its own 3d pass
+    ctx.render_on_demand = false;
+
+    RenderTexture2D target = LoadRenderTexture(SCREEN_W, SCREEN_H);
+    ctx.offscreen_target = &target;
+
+    // drawing the same ctx, its meshes are kept cpu side
+    soft_frame_t soft;
+    init_soft_frame(&soft, &ctx, SCREEN_W, SCREEN_H, 0);
+
+    int failed = 0;
+
+    for (int weapon = 0; weapon < ctx.weapons.count; weapon++) {
+        golden_select_weapon(&ctx, weapon);
+
+        for (int i = 0; i < GOLDEN_POSE_COUNT; i++) {
+            // the orbit is stopped, the frame's tick leaves the pose as is
+            golden_set_pose(&ctx, &GOLDEN_POSES[i]);
+            golden_settle_textures(&ctx);
+
+            // the fps counter is the only part of the frame
+            // depending on the machine
+            ui_set_visible(&ctx.ui, ctx.hud.fps, false);
+            ctx_internal_update(&ctx);
+
+            char name[GOLDEN_PATH_MAX_LENGTH];
+            snprintf(name, sizeof(name), "weapon%d_%s", weapon,
+                     GOLDEN_POSES[i].name);
+
+            Image const frame = load_offscreen_frame(target);
+            failed += !golden_check(frame, name, update,
+                                    GOLDEN_GPU_PIXEL_THRESHOLD,
+                                    GOLDEN_GPU_MAX_DIFF_RATIO);
+            UnloadImage(frame);
+
+            // the hud the frame loop just updated
+            char soft_name[GOLDEN_PATH_MAX_LENGTH];
+            snprintf(soft_name, sizeof(soft_name), "weapon%d_%s.soft", weapon,
+                     GOLDEN_POSES[i].name);
+
+            soft_draw_ctx(&soft, &ctx);
+            Image const soft_frame = soft_target_image(&soft.target);
+            failed += !golden_check(soft_frame, soft_name, update,
+                                    GOLDEN_PIXEL_THRESHOLD,
+                                    GOLDEN_MAX_DIFF_RATIO);
+            UnloadImage(soft_frame);
+        }
+    }
+
+    printf("%d of %d cases failed\n", failed,
+           ctx.weapons.count * GOLDEN_POSE_COUNT * 2);
+
+    deinit_soft_frame(&soft);
+    ctx.offscreen_target = NULL;
+    UnloadRenderTexture(target);
+    deinit_ctx(&ctx);
+    deinit_headless_gl(&gl);
+    return failed;
+}
@@ -0,0 +1,40 @@
+#ifndef SOURCE_GOLDEN_C
+#define SOURCE_GOLDEN_C
+
+#include "Context.h"
+
+// reference frames, two pngs per weapon and pose: the gpu
+// frame (name.png) and the cpu rasterizer's (name.soft.png)
+#define GOLDEN_REFERENCE_DIR ((char const*)"Res/Golden")
+// frames of the failed cases and their diff images
+#define GOLDEN_OUTPUT_DIR ((char const*)"Build/Golden")
+#define GOLDEN_PATH_MAX_LENGTH ((int)256)
+
+// yiq distance (0 to 1) from which a pixel counts as different,
+// as pixelmatch's default threshold
+#define GOLDEN_PIXEL_THRESHOLD ((float)0.1)
+// share of different pixels a frame may have and still pass,
+// for the rounding of a different compiler or simd width
+#define GOLDEN_MAX_DIFF_RATIO ((float)0.001)
+// the gpu frames vary with the driver (texture filtering, blending
+// precision, rasterization rules), their comparison is looser
+#define GOLDEN_GPU_PIXEL_THRESHOLD ((float)0.15)
+#define GOLDEN_GPU_MAX_DIFF_RATIO ((float)0.01)
+
+// a camera pose rendered for every weapon
+typedef struct {
+    char const* name;
+    float orbit_angle;
+    float fovy;
+} golden_pose_t;
+
+// renders every weapon at every pose through the frame loop (3d pass,
+// post-processing and hud on gl, into an offscreen target) and again
+// with the cpu rasterizer (the same frame on any machine), then
+// compares both frames to their references, writing the failed frames
+// and their diffs. with update set, the references are rewritten
+// instead. returns the number of failed cases, 1 when there are no
+// references yet (Res/Golden is made by the first --golden update)
+int run_golden(bool update);
+
+#endif
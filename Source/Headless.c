@@ -0,0 +1,202 @@
+#include "Headless.h"
+
+#if HEADLESS_EGL
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+
+// the surfaceless platform needs no display server at all,
+// the default display is the fallback
+EGLDisplay headless_egl_display() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC const get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+            "eglGetPlatformDisplayEXT");
+
+    if (get_platform_display != NULL) {
+        EGLDisplay const display = get_platform_display(
+            EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool init_headless_gl(headless_gl_t* gl) {
+    *gl = (headless_gl_t){0};
+
+    EGLDisplay const display = headless_egl_display();
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        TraceLog(LOG_WARNING, "HEADLESS: No egl display");
+        return false;
+    }
+
+    EGLint const config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE};
+    // the version and profile raylib's gl 3.3 backend expects
+    EGLint const context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLint const surface_attributes[] = {
+        EGL_WIDTH, (EGLint)SCREEN_W,
+        EGL_HEIGHT, (EGLint)SCREEN_H,
+        EGL_NONE};
+
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(display, config_attributes, &config, 1,
+                         &config_count) ||
+        config_count == 0 || !eglBindAPI(EGL_OPENGL_API)) {
+        TraceLog(LOG_WARNING, "HEADLESS: No egl config for desktop gl");
+        eglTerminate(display);
+        return false;
+    }
+
+    EGLContext const context =
+        eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    // every frame is drawn into render textures, the pbuffer only
+    // backs the default framebuffer rlgl binds between them. without
+    // one the context is made current surfaceless
+    EGLSurface const surface =
+        eglCreatePbufferSurface(display, config, surface_attributes);
+
+    if (context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(display, surface, surface, context)) {
+        TraceLog(LOG_WARNING, "HEADLESS: Failed to create the egl context");
+
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        if (context != EGL_NO_CONTEXT)
+            eglDestroyContext(display, context);
+
+        eglTerminate(display);
+        return false;
+    }
+
+    // what InitWindow does once its context is current
+    rlLoadExtensions((void*)eglGetProcAddress);
+    rlglInit(SCREEN_W, SCREEN_H);
+
+    gl->display = display;
+    gl->surface = surface;
+    gl->context = context;
+    gl->is_ready = true;
+    return true;
+}
+
+void deinit_headless_gl(headless_gl_t* gl) {
+    if (!gl->is_ready)
+        return;
+
+    rlglClose();
+    eglMakeCurrent(gl->display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+    if (gl->surface != EGL_NO_SURFACE)
+        eglDestroySurface(gl->display, gl->surface);
+
+    eglDestroyContext(gl->display, gl->context);
+    eglTerminate(gl->display);
+    *gl = (headless_gl_t){0};
+}
+
+void present_headless_gl(headless_gl_t* gl) {
+    // the frame is in the target, the swap only flushes it. surfaceless
+    // contexts have nothing to swap, the target is read back at the end
+    if (gl->is_ready && gl->surface != EGL_NO_SURFACE)
+        eglSwapBuffers(gl->display, gl->surface);
+}
+#else
+bool init_headless_gl(headless_gl_t* gl) {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(SCREEN_W, SCREEN_H, TITLE);
+
+    *gl = (headless_gl_t){.is_ready = IsWindowReady()};
+    return gl->is_ready;
+}
+
+void deinit_headless_gl(headless_gl_t* gl) {
+    if (gl->is_ready)
+        CloseWindow();
+
+    *gl = (headless_gl_t){0};
+}
+
+void present_headless_gl(headless_gl_t* gl) {
+    if (!gl->is_ready)
+        return;
+
+    SwapScreenBuffer();
+    PollInputEvents();
+}
+#endif
+
+Image load_offscreen_frame(RenderTexture2D target) {
+    // render textures are stored bottom up
+    Image frame = LoadImageFromTexture(target.texture);
+    ImageFlipVertical(&frame);
+    return frame;
+}
+
+int run_headless(int frames, char const* output_path) {
+    if (frames <= 0)
+        frames = HEADLESS_DEFAULT_FRAMES;
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    headless_gl_t gl;
+    if (!init_headless_gl(&gl))
+        return 1;
+
+    ctx_t ctx;
+    init_ctx(&ctx);
+
+    RenderTexture2D target = LoadRenderTexture(SCREEN_W, SCREEN_H);
+    ctx.offscreen_target = &target;
+    // no one to type, the demo only orbits,
+    // one tick per frame as in the benchmarks
+    ctx.is_input_scripted = true;
+    ctx.input = (input_t){0};
+
+    frame_timings_t sum = {0};
+    for (int i = 0; i < frames; i++) {
+        ctx_internal_update(&ctx);
+
+        double const present_start = profiler_time();
+        present_headless_gl(&gl);
+
+        sum.update += ctx.timings.update;
+        sum.draw_3d += ctx.timings.draw_3d;
+        sum.ui += ctx.timings.ui;
+        sum.present += ctx.timings.present + profiler_time() - present_start;
+    }
+
+    printf("%d headless frames, mean times in ms\n", frames);
+    printf("update %.3f draw_3d %.3f ui %.3f present %.3f\n",
+           sum.update / frames * 1000, sum.draw_3d / frames * 1000,
+           sum.ui / frames * 1000, sum.present / frames * 1000);
+    printf("3d passes: %lld drawn, %lld reused\n",
+           (long long)ctx.drawn_scenes, (long long)ctx.reused_scenes);
+
+    Image frame = load_offscreen_frame(target);
+    bool const ok = ExportImage(frame, output_path);
+    UnloadImage(frame);
+
+    if (!ok)
+        TraceLog(LOG_WARNING, "HEADLESS: [%s] Failed to write the frame",
+                 output_path);
+
+    ctx.offscreen_target = NULL;
+    UnloadRenderTexture(target);
+    deinit_ctx(&ctx);
+    deinit_headless_gl(&gl);
+    return ok ? 0 : 1;
+}
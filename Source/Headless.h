@@ -0,0 +1,45 @@
+#ifndef SOURCE_HEADLESS_C
+#define SOURCE_HEADLESS_C
+
+#include "Context.h"
+
+#define HEADLESS_DEFAULT_FRAMES ((int)600)
+#define HEADLESS_DEFAULT_OUTPUT_PATH ((char const*)"Build/Headless.png")
+
+// compile with -DHEADLESS_EGL=1 (and link libEGL) to create the gl
+// context of headless runs through egl, surfaceless, so that they
+// need no window system. otherwise the platform layer opens a
+// hidden window for its context
+#ifndef HEADLESS_EGL
+    #define HEADLESS_EGL 0
+#endif
+
+// the gl context of a headless run, SCREEN_W x SCREEN_H
+typedef struct {
+#if HEADLESS_EGL
+    // EGLDisplay, EGLSurface and EGLContext
+    void* display;
+    void* surface;
+    void* context;
+#endif
+    bool is_ready;
+} headless_gl_t;
+
+// makes the context current and loads rlgl on it,
+// false when no context could be created
+bool init_headless_gl(headless_gl_t* gl);
+void deinit_headless_gl(headless_gl_t* gl);
+
+// ends a frame drawn offscreen: swaps the egl surface, or the
+// hidden window's buffers and polls its events as EndDrawing would
+void present_headless_gl(headless_gl_t* gl);
+
+// the frame presented into the target, top down
+Image load_offscreen_frame(RenderTexture2D target);
+
+// runs the unchanged frame loop (loaders, streaming, 3d pass,
+// post-processing, hud) presenting into an offscreen target, then
+// writes the last frame as a png and prints the frame times
+int run_headless(int frames, char const* output_path);
+
+#endif
@@ -0,0 +1,156 @@
+#include "Jobs.h"
+
+#if defined(_WIN32)
+    // provided by winpthreads, avoids pulling windows.h
+    // which clashes with raylib's names
+    int pthread_num_processors_np(void);
+#else
+    #include <unistd.h>
+#endif
+
+int hardware_thread_count() {
+#if defined(_WIN32)
+    int const count = pthread_num_processors_np();
+#else
+    int const count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return count > 0 ? count : 1;
+}
+
+// pops the next job, blocking until there is one.
+// returns false when the pool is quitting and the queue is empty
+bool jobs_pop(jobs_t* jobs, job_t* job) {
+    pthread_mutex_lock(&jobs->mutex);
+
+    while (jobs->queue_count == 0 && !jobs->quitting)
+        pthread_cond_wait(&jobs->has_work, &jobs->mutex);
+
+    bool const has_job = jobs->queue_count > 0;
+    if (has_job) {
+        *job = jobs->queue[jobs->queue_head];
+        jobs->queue_head = (jobs->queue_head + 1) % jobs->queue_capacity;
+        jobs->queue_count--;
+    }
+
+    pthread_mutex_unlock(&jobs->mutex);
+    return has_job;
+}
+
+void jobs_complete(jobs_t* jobs, job_group_t* group) {
+    if (group == NULL)
+        return;
+
+    pthread_mutex_lock(&jobs->mutex);
+
+    if (--group->pending == 0)
+        pthread_cond_broadcast(&jobs->group_done);
+
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+void* jobs_worker(void* arg) {
+    jobs_t* const jobs = arg;
+    job_t job;
+
+    while (jobs_pop(jobs, &job)) {
+        job.fn(job.arg);
+        jobs_complete(jobs, job.group);
+    }
+
+    return NULL;
+}
+
+void init_jobs(jobs_t* jobs, int worker_count) {
+    if (worker_count <= 0)
+        worker_count = hardware_thread_count();
+
+    if (worker_count > JOBS_MAX_WORKERS)
+        worker_count = JOBS_MAX_WORKERS;
+
+    jobs->queue_capacity = JOBS_QUEUE_INITIAL_CAPACITY;
+    jobs->queue = malloc(sizeof(job_t) * jobs->queue_capacity);
+    jobs->queue_head = 0;
+    jobs->queue_count = 0;
+    jobs->quitting = false;
+
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->has_work, NULL);
+    pthread_cond_init(&jobs->group_done, NULL);
+
+    jobs->worker_count = 0;
+    for (int i = 0; i < worker_count; i++)
+        if (pthread_create(&jobs->workers[jobs->worker_count], NULL,
+                           jobs_worker, jobs) == 0)
+            jobs->worker_count++;
+}
+
+void deinit_jobs(jobs_t* jobs) {
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->quitting = true;
+    pthread_cond_broadcast(&jobs->has_work);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    for (int i = 0; i < jobs->worker_count; i++)
+        pthread_join(jobs->workers[i], NULL);
+
+    pthread_cond_destroy(&jobs->group_done);
+    pthread_cond_destroy(&jobs->has_work);
+    pthread_mutex_destroy(&jobs->mutex);
+    free(jobs->queue);
+}
+
+// doubles the ring buffer, unrolling it so that the head is at 0
+void jobs_grow_queue(jobs_t* jobs) {
+    int const capacity = jobs->queue_capacity * 2;
+    job_t* const queue = malloc(sizeof(job_t) * capacity);
+
+    for (int i = 0; i < jobs->queue_count; i++)
+        queue[i] = jobs->queue[(jobs->queue_head + i) % jobs->queue_capacity];
+
+    free(jobs->queue);
+    jobs->queue = queue;
+    jobs->queue_capacity = capacity;
+    jobs->queue_head = 0;
+}
+
+void jobs_push(jobs_t* jobs, job_fn_t fn, void* arg, job_group_t* group) {
+    // without workers the job runs inline
+    if (jobs->worker_count == 0) {
+        fn(arg);
+        return;
+    }
+
+    pthread_mutex_lock(&jobs->mutex);
+
+    if (jobs->queue_count == jobs->queue_capacity)
+        jobs_grow_queue(jobs);
+
+    int const tail =
+        (jobs->queue_head + jobs->queue_count) % jobs->queue_capacity;
+    jobs->queue[tail] = (job_t){.fn = fn, .arg = arg, .group = group};
+    jobs->queue_count++;
+
+    if (group != NULL)
+        group->pending++;
+
+    pthread_cond_signal(&jobs->has_work);
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+void jobs_wait(jobs_t* jobs, job_group_t* group) {
+    pthread_mutex_lock(&jobs->mutex);
+
+    while (group->pending > 0)
+        pthread_cond_wait(&jobs->group_done, &jobs->mutex);
+
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+bool jobs_is_done(jobs_t* jobs, job_group_t* group) {
+    pthread_mutex_lock(&jobs->mutex);
+    bool const is_done = group->pending == 0;
+    pthread_mutex_unlock(&jobs->mutex);
+
+    return is_done;
+}
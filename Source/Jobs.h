@@ -0,0 +1,58 @@
+#ifndef SOURCE_JOBS_C
+#define SOURCE_JOBS_C
+
+#include "Base.h"
+#include <pthread.h>
+
+#define JOBS_MAX_WORKERS ((int)64)
+#define JOBS_QUEUE_INITIAL_CAPACITY ((int)64)
+
+typedef void (*job_fn_t)(void* arg);
+
+// counts the jobs of a batch still running,
+// so that the batch can be waited as a whole
+typedef struct {
+    int pending;
+} job_group_t;
+
+typedef struct {
+    job_fn_t fn;
+    void* arg;
+    job_group_t* group;
+} job_t;
+
+// fixed pool of worker threads consuming a fifo queue
+typedef struct {
+    pthread_t workers[JOBS_MAX_WORKERS];
+    int worker_count;
+
+    // ring buffer of queued jobs
+    job_t* queue;
+    int queue_capacity;
+    int queue_head;
+    int queue_count;
+
+    pthread_mutex_t mutex;
+    // signaled when a job is queued or the pool quits
+    pthread_cond_t has_work;
+    // signaled when a group reaches zero pending jobs
+    pthread_cond_t group_done;
+    bool quitting;
+} jobs_t;
+
+// number of hardware threads of the machine
+int hardware_thread_count();
+
+// spawns the workers, worker_count <= 0 means one per hardware thread
+void init_jobs(jobs_t* jobs, int worker_count);
+// drains the queue and joins the workers
+void deinit_jobs(jobs_t* jobs);
+
+// queues a job, group is optional
+void jobs_push(jobs_t* jobs, job_fn_t fn, void* arg, job_group_t* group);
+// blocks until every job of the group is done
+void jobs_wait(jobs_t* jobs, job_group_t* group);
+// whether every job of the group is done, never blocks
+bool jobs_is_done(jobs_t* jobs, job_group_t* group);
+
+#endif
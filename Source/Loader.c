@@ -0,0 +1,233 @@
+#include "Loader.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "Profiler.h"
+#include "StartupReport.h"
+
+int weapon_texture_material_map(weapon_texture_t texture) {
+    switch (texture) {
+        case WEAPON_TEXTURE_BASE_COLOR: return MATERIAL_MAP_DIFFUSE;
+        case WEAPON_TEXTURE_NORMAL: return MATERIAL_MAP_NORMAL;
+        case WEAPON_TEXTURE_ROUGHNESS: return MATERIAL_MAP_ROUGHNESS;
+        case WEAPON_TEXTURE_EMISSIVE: return MATERIAL_MAP_EMISSION;
+        default: return MATERIAL_MAP_DIFFUSE;
+    }
+}
+
+// job argument to decode a single image of a weapon
+typedef struct {
+    char const* path;
+    int max_size;
+    Image* image;
+    texture_cache_header_t* header;
+} image_job_t;
+
+// the levels of detail and bvh of the loaded model,
+// each step reported on its own
+void weapon_load_generate(weapon_load_t* load, Model const* model) {
+    char const* const path = load->desc->model_path;
+
+    double start = profiler_time();
+    load->lods = generate_model_lods(model);
+    startup_report_add("lods", path, start, 0);
+
+    start = profiler_time();
+    load->bvh = build_model_bvh(model);
+    startup_report_add("bvh", path, start, 0);
+}
+
+void load_model_job(void* arg) {
+    PROFILE_ZONE("load_model_job");
+
+    weapon_load_t* const load = arg;
+    double const start = profiler_time();
+    load->model_from_cache =
+        mesh_cache_load_cpu(load->desc->model_path, &load->model);
+
+    if (!load->model_from_cache)
+        return;
+
+    char cache_path[MESH_CACHE_PATH_MAX_LENGTH];
+    mesh_cache_path(load->desc->model_path, cache_path, sizeof(cache_path));
+    startup_report_add("mesh_cache", load->desc->model_path, start,
+                       startup_asset_bytes(cache_path));
+
+    weapon_load_generate(load, &load->model);
+}
+
+void load_image_job(void* arg) {
+    PROFILE_ZONE("load_image_job");
+
+    image_job_t* const job = arg;
+    double const start = profiler_time();
+    bool from_cache;
+    *job->image =
+        load_image_cached(job->path, job->max_size, &from_cache, job->header);
+
+    if (from_cache) {
+        char cache_path[TEXTURE_CACHE_PATH_MAX_LENGTH];
+        texture_cache_path(job->path, cache_path, sizeof(cache_path));
+        startup_report_add("texture_cache", job->path, start,
+                           startup_asset_bytes(cache_path));
+    } else {
+        startup_report_add("image", job->path, start,
+                           startup_asset_bytes(job->path));
+    }
+
+    free(job);
+}
+
+void weapon_load_push(jobs_t* jobs, job_group_t* group, weapon_load_t* load) {
+    load->model = (Model){0};
+    load->model_from_cache = false;
+    load->lods = (model_lods_t){0};
+    load->bvh = (model_bvh_t){0};
+    jobs_push(jobs, load_model_job, load, group);
+
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT; i++) {
+        load->images[i] = (Image){0};
+        load->texture_headers[i] = (texture_cache_header_t){0};
+
+        if (load->desc->texture_paths[i] == NULL || load->is_cpu_only)
+            continue;
+
+        image_job_t* const job = malloc(sizeof(image_job_t));
+        *job = (image_job_t){.path = load->desc->texture_paths[i],
+                             .max_size = load->texture_max_size,
+                             .image = &load->images[i],
+                             .header = &load->texture_headers[i]};
+        jobs_push(jobs, load_image_job, job, group);
+    }
+}
+
+Model weapon_load_finish(weapon_load_t* load) {
+    PROFILE_ZONE("weapon_load_finish");
+
+    Model model = load->model;
+
+    // the obj loader uploads while parsing, so the fallback can only
+    // run here. it reports its own steps, the upload starts after them
+    if (!load->model_from_cache) {
+        model = load_model_cached(load->desc->model_path, NULL);
+        weapon_load_generate(load, &model);
+    }
+
+    double const start = profiler_time();
+
+    if (load->model_from_cache)
+        upload_model_meshes(&model);
+
+    upload_model_lods(&load->lods);
+    load->lods.meshes[0] = model.meshes;
+
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT; i++) {
+        if (load->images[i].data == NULL)
+            continue;
+
+        model.materials[0]
+            .maps[weapon_texture_material_map(i)]
+            .texture = load_texture_levels(load->images[i]);
+        UnloadImage(load->images[i]);
+    }
+
+    startup_report_add("upload", load->desc->model_path, start, 0);
+    return model;
+}
+
+Model weapon_load_finish_cpu(weapon_load_t* load) {
+    PROFILE_ZONE("weapon_load_finish_cpu");
+
+    if (!load->model_from_cache) {
+        TraceLog(LOG_WARNING,
+                 "WEAPON: [%s] No mesh cache, can't load without gl",
+                 load->desc->model_path);
+        return (Model){0};
+    }
+
+    load->lods.meshes[0] = load->model.meshes;
+    return load->model;
+}
+
+void weapon_load_discard(weapon_load_t* load) {
+    if (load->model_from_cache) {
+        unload_model_lods_cpu(&load->lods);
+        unload_model_bvh(&load->bvh);
+        unload_model_cpu(load->model);
+    }
+
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT; i++)
+        UnloadImage(load->images[i]);
+}
+
+size_t mesh_memory_size(Mesh mesh) {
+    size_t const floats_per_vertex = 3 + (mesh.texcoords ? 2 : 0) +
+                                     (mesh.texcoords2 ? 2 : 0) +
+                                     (mesh.normals ? 3 : 0) +
+                                     (mesh.tangents ? 4 : 0);
+
+    return (size_t)mesh.vertexCount *
+               (floats_per_vertex * sizeof(float) + (mesh.colors ? 4 : 0)) +
+           (mesh.indices ? (size_t)mesh.triangleCount * 3 *
+                               sizeof(unsigned short) : 0);
+}
+
+size_t model_memory_size(Model model) {
+    size_t size = 0;
+
+    // meshes stay cpu-side after the upload as well
+    for (int i = 0; i < model.meshCount; i++)
+        size += mesh_memory_size(model.meshes[i]) * 2;
+
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT && model.materialCount > 0;
+         i++) {
+        Texture2D const texture = model.materials[0]
+                                      .maps[weapon_texture_material_map(i)]
+                                      .texture;
+
+        if (texture.id == rlGetTextureIdDefault())
+            continue;
+
+        for (int level = 0, w = texture.width, h = texture.height;
+             level < texture.mipmaps;
+             level++, w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1)
+            size += GetPixelDataSize(w, h, texture.format);
+    }
+
+    return size;
+}
+
+void load_weapons(jobs_t* jobs, weapon_desc_t const* descs, int count,
+                  int texture_max_size, bool is_cpu_only,
+                  weapon_load_t* loads, Model* models, model_lods_t* lods,
+                  model_bvh_t* bvhs) {
+    double const start_time = profiler_time();
+    job_group_t group = {0};
+
+    for (int i = 0; i < count; i++) {
+        loads[i].desc = &descs[i];
+        loads[i].texture_max_size = texture_max_size;
+        loads[i].is_cpu_only = is_cpu_only;
+        weapon_load_push(jobs, &group, &loads[i]);
+    }
+
+    jobs_wait(jobs, &group);
+    double const decoded_time = profiler_time();
+
+    // gpu uploads in one batch
+    for (int i = 0; i < count; i++) {
+        models[i] = is_cpu_only ? weapon_load_finish_cpu(&loads[i])
+                                : weapon_load_finish(&loads[i]);
+        lods[i] = loads[i].lods;
+        bvhs[i] = loads[i].bvh;
+
+        TraceLog(LOG_INFO, "WEAPON: [%s] Model loaded from %s",
+                 descs[i].model_path,
+                 loads[i].model_from_cache ? "cache" : "obj");
+    }
+
+    TraceLog(LOG_INFO,
+             "WEAPON: %d weapons decoded in %.2f ms on %d workers, "
+             "uploaded in %.2f ms",
+             count, (decoded_time - start_time) * 1000, jobs->worker_count,
+             (profiler_time() - decoded_time) * 1000);
+}
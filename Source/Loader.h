@@ -0,0 +1,84 @@
+#ifndef SOURCE_LOADER_C
+#define SOURCE_LOADER_C
+
+#include "Base.h"
+#include "RayLib.h"
+#include "Jobs.h"
+#include "Lod.h"
+#include "Bvh.h"
+#include "TextureCache.h"
+
+// texture maps a weapon can provide,
+// all of them bound to the model's first material
+typedef enum {
+    WEAPON_TEXTURE_BASE_COLOR,
+    WEAPON_TEXTURE_NORMAL,
+    WEAPON_TEXTURE_ROUGHNESS,
+    WEAPON_TEXTURE_EMISSIVE,
+    WEAPON_TEXTURE_COUNT
+} weapon_texture_t;
+
+// static description of a weapon's assets,
+// null texture paths are skipped
+typedef struct {
+    char const* texture_paths[WEAPON_TEXTURE_COUNT];
+    char const* model_path;
+    char const* name;
+    float scale;
+} weapon_desc_t;
+
+// state of a weapon being loaded, filled by the workers
+// (cpu side) and then finished on the main thread (gpu side)
+typedef struct {
+    weapon_desc_t const* desc;
+    // textures are loaded from the first level fitting it (0 for all)
+    int texture_max_size;
+    // the model stays cpu side and no texture is
+    // decoded (renderers without gl, see soft_frame_t)
+    bool is_cpu_only;
+
+    Model model;
+    bool model_from_cache;
+    // simplified levels of the model, generated along with it
+    model_lods_t lods;
+    // ray queries against the model's meshes
+    model_bvh_t bvh;
+    Image images[WEAPON_TEXTURE_COUNT];
+    // full chains of the texture caches, to stream the other levels
+    texture_cache_header_t texture_headers[WEAPON_TEXTURE_COUNT];
+} weapon_load_t;
+
+// material map slot of each weapon texture
+int weapon_texture_material_map(weapon_texture_t texture);
+
+// queues the cpu-side decoding (mesh cache, images) of a weapon
+void weapon_load_push(jobs_t* jobs, job_group_t* group, weapon_load_t* load);
+
+// uploads the decoded data of a weapon and returns its model,
+// parsing the source model here when it had no fresh cache.
+// the model's levels of detail and bvh are left in
+// load->lods and load->bvh (gl thread only)
+Model weapon_load_finish(weapon_load_t* load);
+
+// weapon_load_finish without gl for cpu only loads: the model and
+// its levels stay cpu side and have no textures. the model is empty
+// when it had no fresh cache (the source parser uploads)
+Model weapon_load_finish_cpu(weapon_load_t* load);
+
+// frees the decoded data of a load that won't be finished,
+// the load's jobs must be done
+void weapon_load_discard(weapon_load_t* load);
+
+// estimated bytes taken by the model's vertex data and textures
+size_t model_memory_size(Model model);
+
+// loads the models of every weapon, decoding in parallel
+// on the workers and uploading in one batch on the calling thread
+// (finished by weapon_load_finish_cpu when is_cpu_only).
+// loads (count elements) are left as the finish leaves them
+void load_weapons(jobs_t* jobs, weapon_desc_t const* descs, int count,
+                  int texture_max_size, bool is_cpu_only,
+                  weapon_load_t* loads, Model* models, model_lods_t* lods,
+                  model_bvh_t* bvhs);
+
+#endif
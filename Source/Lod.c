@@ -0,0 +1,317 @@
+#include "Lod.h"
+#include "MeshCache.h"
+#include <string.h>
+#include <math.h>
+
+// a simplified level is kept only if it removes at least this
+// share of the previous level's triangles
+#define LOD_MIN_REDUCTION ((float)0.2)
+
+// vertices of a mesh falling into the same grid cell
+typedef struct {
+    int64_t key;
+    Vector3 position_sum;
+    Vector3 normal_sum;
+    int count;
+    // attributes without averaging come from this vertex
+    int first_vertex;
+    // index in the simplified mesh, -1 until a triangle uses it
+    int output_index;
+} lod_cluster_t;
+
+int mesh_corner_vertex(Mesh const* mesh, int corner) {
+    return mesh->indices != NULL ? mesh->indices[corner] : corner;
+}
+
+Vector3 mesh_vertex_position(Mesh const* mesh, int v) {
+    return vec3(mesh->vertices[v * 3], mesh->vertices[v * 3 + 1],
+                mesh->vertices[v * 3 + 2]);
+}
+
+BoundingBox mesh_bounds(Mesh const* mesh) {
+    BoundingBox bounds = {.min = scalar_to_vec3(INFINITY),
+                          .max = scalar_to_vec3(-INFINITY)};
+
+    for (int v = 0; v < mesh->vertexCount; v++) {
+        Vector3 const p = mesh_vertex_position(mesh, v);
+        bounds.min = Vector3Min(bounds.min, p);
+        bounds.max = Vector3Max(bounds.max, p);
+    }
+
+    return bounds;
+}
+
+BoundingBox boxes_union(BoundingBox const* boxes, int count) {
+    BoundingBox bounds = {.min = scalar_to_vec3(INFINITY),
+                          .max = scalar_to_vec3(-INFINITY)};
+
+    for (int i = 0; i < count; i++) {
+        bounds.min = Vector3Min(bounds.min, boxes[i].min);
+        bounds.max = Vector3Max(bounds.max, boxes[i].max);
+    }
+
+    return bounds;
+}
+
+int64_t lod_cell_key(Vector3 p, Vector3 origin, float cell_size) {
+    int64_t const x = (int64_t)((p.x - origin.x) / cell_size);
+    int64_t const y = (int64_t)((p.y - origin.y) / cell_size);
+    int64_t const z = (int64_t)((p.z - origin.z) / cell_size);
+    return x | (y << 21) | (z << 42);
+}
+
+// cluster of the key in the open addressing table, created when missing
+int lod_find_cluster(int* table, int table_size, lod_cluster_t* clusters,
+                     int* cluster_count, int64_t key) {
+    uint32_t slot =
+        (uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> 32) &
+        (table_size - 1);
+
+    while (table[slot] >= 0 && clusters[table[slot]].key != key)
+        slot = (slot + 1) & (table_size - 1);
+
+    if (table[slot] < 0) {
+        table[slot] = (*cluster_count)++;
+        clusters[table[slot]] = (lod_cluster_t){.key = key,
+                                                .first_vertex = -1,
+                                                .output_index = -1};
+    }
+
+    return table[slot];
+}
+
+// vertex clustering of a mesh: every vertex snaps to the average of its
+// cell and the triangles collapsing to a line or a point are dropped
+Mesh simplify_mesh(Mesh const* mesh, Vector3 origin, float cell_size) {
+    int const vertex_count = mesh->vertexCount;
+    Mesh simplified = {0};
+
+    if (vertex_count <= 0 || mesh->triangleCount <= 0)
+        return simplified;
+
+    int table_size = 1;
+    while (table_size < vertex_count * 2)
+        table_size *= 2;
+
+    int* const table = malloc(sizeof(int) * table_size);
+    memset(table, -1, sizeof(int) * table_size);
+    lod_cluster_t* const clusters = malloc(sizeof(lod_cluster_t) * vertex_count);
+    int* const vertex_clusters = malloc(sizeof(int) * vertex_count);
+    int cluster_count = 0;
+
+    for (int v = 0; v < vertex_count; v++) {
+        Vector3 const p = mesh_vertex_position(mesh, v);
+        int const c = lod_find_cluster(table, table_size, clusters,
+                                       &cluster_count,
+                                       lod_cell_key(p, origin, cell_size));
+        lod_cluster_t* const cluster = &clusters[c];
+
+        cluster->position_sum = Vector3Add(cluster->position_sum, p);
+        if (mesh->normals != NULL)
+            cluster->normal_sum = Vector3Add(
+                cluster->normal_sum,
+                vec3(mesh->normals[v * 3], mesh->normals[v * 3 + 1],
+                     mesh->normals[v * 3 + 2]));
+        if (cluster->first_vertex < 0)
+            cluster->first_vertex = v;
+        cluster->count++;
+
+        vertex_clusters[v] = c;
+    }
+
+    // surviving triangles, numbering the clusters they use
+    unsigned short* const indices =
+        RL_MALLOC(sizeof(unsigned short) * mesh->triangleCount * 3);
+    int triangle_count = 0;
+    int output_count = 0;
+    bool overflow = false;
+
+    for (int t = 0; t < mesh->triangleCount && !overflow; t++) {
+        int const a = vertex_clusters[mesh_corner_vertex(mesh, t * 3)];
+        int const b = vertex_clusters[mesh_corner_vertex(mesh, t * 3 + 1)];
+        int const c = vertex_clusters[mesh_corner_vertex(mesh, t * 3 + 2)];
+
+        if (a == b || b == c || a == c)
+            continue;
+
+        int const corners[3] = {a, b, c};
+        for (int k = 0; k < 3; k++) {
+            lod_cluster_t* const cluster = &clusters[corners[k]];
+
+            if (cluster->output_index < 0)
+                cluster->output_index = output_count++;
+
+            indices[triangle_count * 3 + k] =
+                (unsigned short)cluster->output_index;
+        }
+
+        triangle_count++;
+        overflow = output_count > 65535;
+    }
+
+    if (overflow) {
+        RL_FREE(indices);
+        simplified.triangleCount = mesh->triangleCount;
+    } else {
+        // raylib frees every stream of the mesh,
+        // so even empty levels get allocations
+        int const allocated = output_count > 0 ? output_count : 1;
+        simplified.vertexCount = output_count;
+        simplified.triangleCount = triangle_count;
+        simplified.indices = indices;
+        simplified.vertices = RL_CALLOC(allocated * 3, sizeof(float));
+        if (mesh->normals != NULL)
+            simplified.normals = RL_CALLOC(allocated * 3, sizeof(float));
+        if (mesh->texcoords != NULL)
+            simplified.texcoords = RL_CALLOC(allocated * 2, sizeof(float));
+        if (mesh->colors != NULL)
+            simplified.colors = RL_CALLOC(allocated * 4, sizeof(unsigned char));
+
+        for (int c = 0; c < cluster_count; c++) {
+            lod_cluster_t const* const cluster = &clusters[c];
+            int const o = cluster->output_index;
+            int const v = cluster->first_vertex;
+
+            if (o < 0)
+                continue;
+
+            Vector3 const p =
+                Vector3Scale(cluster->position_sum, 1.0f / cluster->count);
+            memcpy(&simplified.vertices[o * 3], &p, sizeof(p));
+
+            if (simplified.normals != NULL) {
+                Vector3 const n = Vector3Normalize(cluster->normal_sum);
+                memcpy(&simplified.normals[o * 3], &n, sizeof(n));
+            }
+
+            if (simplified.texcoords != NULL)
+                memcpy(&simplified.texcoords[o * 2], &mesh->texcoords[v * 2],
+                       sizeof(float) * 2);
+
+            if (simplified.colors != NULL)
+                memcpy(&simplified.colors[o * 4], &mesh->colors[v * 4], 4);
+        }
+    }
+
+    free(vertex_clusters);
+    free(clusters);
+    free(table);
+
+    return simplified;
+}
+
+int meshes_triangle_count(Mesh const* meshes, int count) {
+    int triangles = 0;
+    for (int i = 0; i < count; i++)
+        triangles += meshes[i].triangleCount;
+
+    return triangles;
+}
+
+model_lods_t generate_model_lods(Model const* model) {
+    int const mesh_count = model->meshCount;
+    model_lods_t lods = {.count = 1, .mesh_count = mesh_count};
+    lods.meshes[0] = model->meshes;
+
+    if (mesh_count <= 0)
+        return lods;
+
+    // the simplified vertices average vertices of the same
+    // mesh, so these bound the mesh at every level
+    lods.mesh_bounds = RL_MALLOC(sizeof(BoundingBox) * mesh_count);
+    for (int i = 0; i < mesh_count; i++)
+        lods.mesh_bounds[i] = mesh_bounds(&model->meshes[i]);
+
+    BoundingBox const bounds = boxes_union(lods.mesh_bounds, mesh_count);
+    Vector3 const extent = Vector3Subtract(bounds.max, bounds.min);
+    float const longest_side = fmaxf(extent.x, fmaxf(extent.y, extent.z));
+
+    lods.center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+    lods.radius = Vector3Length(extent) * 0.5f;
+
+    for (int level = 1; level < LOD_COUNT && longest_side > 0; level++) {
+        float const cell_size = longest_side / LOD_GRID_RESOLUTIONS[level];
+        Mesh* const meshes = RL_CALLOC(mesh_count, sizeof(Mesh));
+        bool ok = true;
+
+        for (int i = 0; i < mesh_count && ok; i++) {
+            meshes[i] = simplify_mesh(&model->meshes[i], bounds.min, cell_size);
+            // couldn't be indexed
+            ok = meshes[i].indices != NULL || model->meshes[i].vertexCount == 0;
+        }
+
+        int const previous_triangles =
+            meshes_triangle_count(lods.meshes[level - 1], mesh_count);
+        int const triangles = meshes_triangle_count(meshes, mesh_count);
+
+        if (!ok ||
+            triangles > previous_triangles * (1 - LOD_MIN_REDUCTION)) {
+            for (int i = 0; i < mesh_count; i++)
+                unload_mesh_cpu(meshes[i]);
+            RL_FREE(meshes);
+            break;
+        }
+
+        lods.meshes[level] = meshes;
+        lods.cell_sizes[level] = cell_size;
+        lods.count++;
+    }
+
+    return lods;
+}
+
+void upload_model_lods(model_lods_t* lods) {
+    for (int level = 1; level < lods->count; level++)
+        for (int i = 0; i < lods->mesh_count; i++)
+            UploadMesh(&lods->meshes[level][i], false);
+}
+
+void unload_model_lods(model_lods_t* lods) {
+    for (int level = 1; level < lods->count; level++) {
+        for (int i = 0; i < lods->mesh_count; i++)
+            UnloadMesh(lods->meshes[level][i]);
+
+        RL_FREE(lods->meshes[level]);
+    }
+
+    RL_FREE(lods->mesh_bounds);
+    *lods = (model_lods_t){0};
+}
+
+void unload_model_lods_cpu(model_lods_t* lods) {
+    for (int level = 1; level < lods->count; level++) {
+        for (int i = 0; i < lods->mesh_count; i++)
+            unload_mesh_cpu(lods->meshes[level][i]);
+
+        RL_FREE(lods->meshes[level]);
+    }
+
+    RL_FREE(lods->mesh_bounds);
+    *lods = (model_lods_t){0};
+}
+
+float lods_pixels_per_unit(model_lods_t const* lods, Camera3D camera,
+                           Vector3 pos, float scale, float screen_h) {
+    Vector3 const center = Vector3Add(pos, Vector3Scale(lods->center, scale));
+    float const distance = Vector3Distance(camera.position, center);
+
+    return screen_h / (2 * distance * tanf(camera.fovy * 0.5f * DEG2RAD));
+}
+
+int select_lod(model_lods_t const* lods, Camera3D camera, Vector3 pos,
+               float scale, float screen_h) {
+    float const pixels_per_unit =
+        lods_pixels_per_unit(lods, camera, pos, scale, screen_h);
+
+    for (int level = lods->count - 1; level > 0; level--)
+        if (lods->cell_sizes[level] * scale * pixels_per_unit <
+            LOD_MAX_ERROR_PIXELS)
+            return level;
+
+    return 0;
+}
+
+Model lod_model(Model model, model_lods_t const* lods, int level) {
+    model.meshes = lods->meshes[level];
+    return model;
+}
@@ -0,0 +1,53 @@
+#ifndef SOURCE_LOD_C
+#define SOURCE_LOD_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// levels of detail per model, level 0 being the model itself
+#define LOD_COUNT ((int)4)
+// clustering grid resolution (cells along the longest side)
+// of each simplified level
+#define LOD_GRID_RESOLUTIONS ((int[LOD_COUNT]){0, 192, 96, 48})
+// screen-space error allowed when picking a simplified level
+#define LOD_MAX_ERROR_PIXELS ((float)1.5)
+
+// simplified copies of a model's meshes
+typedef struct {
+    // levels generated, simplification stops when it stops paying off
+    int count;
+    int mesh_count;
+    // meshes of each level, as many as the model's meshCount.
+    // level 0 points to the model's meshes and isn't owned
+    Mesh* meshes[LOD_COUNT];
+    // bounds of each mesh, in model space, valid at every level
+    // (and for the wireframe meshes, which share the vertices)
+    BoundingBox* mesh_bounds;
+    // bounding sphere of the model, in model space
+    Vector3 center;
+    float radius;
+    // size in model space of a clustering cell of each level
+    float cell_sizes[LOD_COUNT];
+} model_lods_t;
+
+// simplifies the model's meshes by vertex clustering (cpu side only,
+// safe to call from worker threads)
+model_lods_t generate_model_lods(Model const* model);
+void upload_model_lods(model_lods_t* lods);
+void unload_model_lods(model_lods_t* lods);
+// frees lods generated but never uploaded
+void unload_model_lods_cpu(model_lods_t* lods);
+
+// pixels covered by a world unit at the distance of the model's center
+float lods_pixels_per_unit(model_lods_t const* lods, Camera3D camera,
+                           Vector3 pos, float scale, float screen_h);
+
+// coarsest level whose simplification error stays under
+// LOD_MAX_ERROR_PIXELS once projected by the camera
+int select_lod(model_lods_t const* lods, Camera3D camera, Vector3 pos,
+               float scale, float screen_h);
+
+// the model drawing the meshes of the level (shares the materials)
+Model lod_model(Model model, model_lods_t const* lods, int level);
+
+#endif
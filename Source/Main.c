@@ -1,15 +1,52 @@
 #include "Context.h"
+#include "Bench.h"
+#include "Golden.h"
+#include "Headless.h"
+#include "StartupReport.h"
+#include <string.h>
 
-/*
+// offline bake step, parses every weapon source and the
+// font and rewrites their binary caches (optimized meshes,
+// compressed textures and the font's distance fields), then quits
+int bake() {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(SCREEN_W, SCREEN_H, TITLE);
+
+    bake_ctx_weapons();
+    bake_font_sdf(FONT_PATH);
+
+    CloseWindow();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bake") == 0)
+        return bake();
+
+    // --bench [frames]
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return run_bench(argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_FRAMES,
+                         false);
+
+    // --soft-bench [frames]
+    if (argc > 1 && strcmp(argv[1], "--soft-bench") == 0)
+        return run_bench(argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_FRAMES,
+                         true);
 
-TODO:
-    + white outline for all weapons
+    // --golden [update]
+    if (argc > 1 && strcmp(argv[1], "--golden") == 0)
+        return run_golden(argc > 2 && strcmp(argv[2], "update") == 0);
 
-*/
+    // --headless [frames] [png path]
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0)
+        return run_headless(argc > 2 ? atoi(argv[2]) : HEADLESS_DEFAULT_FRAMES,
+                            argc > 3 ? argv[3] : HEADLESS_DEFAULT_OUTPUT_PATH);
 
-int main() {
+    startup_report_begin();
+    double const window_start = profiler_time();
     InitWindow(SCREEN_W, SCREEN_H, TITLE);
     ToggleFullscreen();
+    startup_report_add("window", NULL, window_start, 0);
     
     ctx_t ctx;
     init_ctx(&ctx);
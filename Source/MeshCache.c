@@ -0,0 +1,384 @@
+#include "MeshCache.h"
+#include "Profiler.h"
+#include "StartupReport.h"
+#include "MeshOpt.h"
+#include <string.h>
+#include <limits.h>
+
+// the blob is stored in host order, so it's only valid
+// on little-endian hosts (every platform we ship on)
+bool is_host_little_endian() {
+    uint16_t const probe = 1;
+    return *(uint8_t const*)&probe == 1;
+}
+
+void mesh_cache_path(char const* model_path, char* buf, int buf_size) {
+    char const* ext = strrchr(model_path, '.');
+    int const stem_length = ext != NULL ? (int)(ext - model_path)
+                                        : (int)strlen(model_path);
+
+    snprintf(buf, buf_size, "%.*s%s", stem_length, model_path,
+             MESH_CACHE_EXTENSION);
+}
+
+// cursor over the loaded blob, reads fail
+// once the cursor would run out of bounds
+typedef struct {
+    uint8_t const* data;
+    size_t size;
+    size_t offset;
+} blob_reader_t;
+
+bool blob_read(blob_reader_t* r, void* dst, size_t size) {
+    if (size > r->size - r->offset)
+        return false;
+
+    memcpy(dst, r->data + r->offset, size);
+    r->offset += size;
+    return true;
+}
+
+size_t blob_remaining(blob_reader_t const* r) {
+    return r->size - r->offset;
+}
+
+// allocates a stream with the raylib allocator (so that UnloadMesh
+// can free it) and fills it from the blob, allocating nothing
+// when the blob is too short for it
+bool blob_read_stream(blob_reader_t* r, void** dst, size_t size) {
+    if (size > blob_remaining(r))
+        return false;
+
+    *dst = RL_MALLOC(size);
+    return blob_read(r, *dst, size);
+}
+
+size_t mesh_stream_size(uint32_t stream, mesh_cache_mesh_t const* m) {
+    switch (stream) {
+        case MESH_STREAM_TEXCOORDS:
+        case MESH_STREAM_TEXCOORDS2:
+            return (size_t)m->vertex_count * 2 * sizeof(float);
+        case MESH_STREAM_NORMALS:
+            return (size_t)m->vertex_count * 3 * sizeof(float);
+        case MESH_STREAM_TANGENTS:
+            return (size_t)m->vertex_count * 4 * sizeof(float);
+        case MESH_STREAM_COLORS:
+            return (size_t)m->vertex_count * 4 * sizeof(unsigned char);
+        case MESH_STREAM_INDICES:
+            return (size_t)m->triangle_count * 3 * sizeof(unsigned short);
+        default:
+            return 0;
+    }
+}
+
+// maps a stream flag to the matching mesh field
+void** mesh_stream_field(Mesh* mesh, uint32_t stream) {
+    switch (stream) {
+        case MESH_STREAM_TEXCOORDS: return (void**)&mesh->texcoords;
+        case MESH_STREAM_TEXCOORDS2: return (void**)&mesh->texcoords2;
+        case MESH_STREAM_NORMALS: return (void**)&mesh->normals;
+        case MESH_STREAM_TANGENTS: return (void**)&mesh->tangents;
+        case MESH_STREAM_COLORS: return (void**)&mesh->colors;
+        case MESH_STREAM_INDICES: return (void**)&mesh->indices;
+        default: return NULL;
+    }
+}
+
+bool mesh_cache_read_mesh(blob_reader_t* r, Mesh* mesh, int* material) {
+    mesh_cache_mesh_t m;
+    if (!blob_read(r, &m, sizeof(m)))
+        return false;
+
+    // counts a corrupt blob can't hold, checked before any allocation
+    uint64_t encoded_size = (uint64_t)m.vertex_count * 3 * sizeof(float);
+    for (uint32_t stream = MESH_STREAM_TEXCOORDS;
+         stream <= MESH_STREAM_INDICES; stream <<= 1)
+        if (m.streams & stream)
+            encoded_size += mesh_stream_size(stream, &m);
+
+    if (m.vertex_count > INT_MAX || m.triangle_count > INT_MAX ||
+        encoded_size > blob_remaining(r))
+        return false;
+
+    *material = m.material;
+    mesh->vertexCount = (int)m.vertex_count;
+    mesh->triangleCount = (int)m.triangle_count;
+
+    if (!blob_read_stream(r, (void**)&mesh->vertices,
+                          (size_t)m.vertex_count * 3 * sizeof(float)))
+        return false;
+
+    for (uint32_t stream = MESH_STREAM_TEXCOORDS;
+         stream <= MESH_STREAM_INDICES; stream <<= 1) {
+        if (!(m.streams & stream))
+            continue;
+
+        if (!blob_read_stream(r, mesh_stream_field(mesh, stream),
+                              mesh_stream_size(stream, &m)))
+            return false;
+    }
+
+    return true;
+}
+
+bool mesh_cache_read_model(blob_reader_t* r, char const* model_path,
+                           Model* model) {
+    mesh_cache_header_t header;
+    if (!blob_read(r, &header, sizeof(header)))
+        return false;
+
+    if (header.magic != MESH_CACHE_MAGIC ||
+        header.version != MESH_CACHE_VERSION ||
+        header.source_mod_time != (int64_t)GetFileModTime(model_path) ||
+        header.source_size != (int64_t)GetFileLength(model_path))
+        return false;
+
+    // every material and mesh takes at least its record,
+    // a count the blob can't hold is rejected before allocating
+    uint64_t const min_size =
+        (uint64_t)header.material_count * sizeof(mesh_cache_material_t) +
+        (uint64_t)header.mesh_count * sizeof(mesh_cache_mesh_t);
+
+    if (header.mesh_count > INT_MAX || header.material_count > INT_MAX ||
+        min_size > blob_remaining(r))
+        return false;
+
+    model->transform = MatrixIdentity();
+    model->meshCount = (int)header.mesh_count;
+    model->materialCount = (int)header.material_count;
+    model->meshes = RL_CALLOC(model->meshCount, sizeof(Mesh));
+    model->materials = RL_CALLOC(model->materialCount, sizeof(Material));
+    model->meshMaterial = RL_CALLOC(model->meshCount, sizeof(int));
+
+    // material bindings
+    for (int i = 0; i < model->materialCount; i++) {
+        mesh_cache_material_t m;
+        if (!blob_read(r, &m, sizeof(m)))
+            return false;
+
+        model->materials[i] = LoadMaterialDefault();
+        for (int j = 0; j < MESH_CACHE_MATERIAL_MAPS; j++) {
+            model->materials[i].maps[j].color = m.colors[j];
+            model->materials[i].maps[j].value = m.values[j];
+        }
+        memcpy(model->materials[i].params, m.params, sizeof(m.params));
+    }
+
+    // vertex streams and indices
+    for (int i = 0; i < model->meshCount; i++) {
+        if (!mesh_cache_read_mesh(r, &model->meshes[i],
+                                  &model->meshMaterial[i]))
+            return false;
+
+        if (!IS_IN_RANGE(model->meshMaterial[i], 0, model->materialCount))
+            return false;
+    }
+
+    return true;
+}
+
+// frees a model that was never uploaded, without touching gl
+// (UnloadModel would, and this can run on worker threads)
+void unload_mesh_cpu(Mesh mesh) {
+    RL_FREE(mesh.vertices);
+    RL_FREE(mesh.texcoords);
+    RL_FREE(mesh.texcoords2);
+    RL_FREE(mesh.normals);
+    RL_FREE(mesh.tangents);
+    RL_FREE(mesh.colors);
+    RL_FREE(mesh.indices);
+}
+
+void unload_model_cpu(Model model) {
+    for (int i = 0; i < model.meshCount; i++)
+        unload_mesh_cpu(model.meshes[i]);
+
+    // materials only reference the default shader and textures
+    for (int i = 0; i < model.materialCount; i++)
+        RL_FREE(model.materials[i].maps);
+
+    RL_FREE(model.meshes);
+    RL_FREE(model.materials);
+    RL_FREE(model.meshMaterial);
+}
+
+bool mesh_cache_load_cpu(char const* model_path, Model* model) {
+    PROFILE_ZONE("mesh_cache_load_cpu");
+
+    if (!is_host_little_endian())
+        return false;
+
+    char cache_path[MESH_CACHE_PATH_MAX_LENGTH];
+    mesh_cache_path(model_path, cache_path, sizeof(cache_path));
+
+    if (!FileExists(cache_path))
+        return false;
+
+    // the whole blob comes in with a single read
+    unsigned int size = 0;
+    uint8_t* data = LoadFileData(cache_path, &size);
+    if (data == NULL)
+        return false;
+
+    blob_reader_t reader = {.data = data, .size = size, .offset = 0};
+    *model = (Model){0};
+    bool const ok = mesh_cache_read_model(&reader, model_path, model);
+    UnloadFileData(data);
+
+    if (!ok) {
+        TraceLog(LOG_WARNING, "MESHCACHE: [%s] Stale or malformed cache",
+                 cache_path);
+        unload_model_cpu(*model);
+        *model = (Model){0};
+        return false;
+    }
+
+    return true;
+}
+
+void upload_model_meshes(Model* model) {
+    for (int i = 0; i < model->meshCount; i++)
+        UploadMesh(&model->meshes[i], false);
+}
+
+bool mesh_cache_load(char const* model_path, Model* model) {
+    if (!mesh_cache_load_cpu(model_path, model))
+        return false;
+
+    upload_model_meshes(model);
+    return true;
+}
+
+// growable output buffer for the blob
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} blob_writer_t;
+
+void blob_write(blob_writer_t* w, void const* src, size_t size) {
+    if (w->size + size > w->capacity) {
+        size_t capacity = w->capacity > 0 ? w->capacity : 4096;
+        while (capacity < w->size + size)
+            capacity *= 2;
+
+        w->data = RL_REALLOC(w->data, capacity);
+        w->capacity = capacity;
+    }
+
+    memcpy(w->data + w->size, src, size);
+    w->size += size;
+}
+
+void mesh_cache_write_mesh(blob_writer_t* w, Mesh const* mesh, int material) {
+    Mesh copy = *mesh;
+    mesh_cache_mesh_t m = {.material = material,
+                           .vertex_count = (uint32_t)mesh->vertexCount,
+                           .triangle_count = (uint32_t)mesh->triangleCount,
+                           .streams = 0};
+
+    for (uint32_t stream = MESH_STREAM_TEXCOORDS;
+         stream <= MESH_STREAM_INDICES; stream <<= 1)
+        if (*mesh_stream_field(&copy, stream) != NULL)
+            m.streams |= stream;
+
+    blob_write(w, &m, sizeof(m));
+    blob_write(w, mesh->vertices, (size_t)m.vertex_count * 3 * sizeof(float));
+
+    for (uint32_t stream = MESH_STREAM_TEXCOORDS;
+         stream <= MESH_STREAM_INDICES; stream <<= 1)
+        if (m.streams & stream)
+            blob_write(w, *mesh_stream_field(&copy, stream),
+                       mesh_stream_size(stream, &m));
+}
+
+bool mesh_cache_save(char const* model_path, Model model) {
+    if (!is_host_little_endian())
+        return false;
+
+    char cache_path[MESH_CACHE_PATH_MAX_LENGTH];
+    mesh_cache_path(model_path, cache_path, sizeof(cache_path));
+
+    blob_writer_t writer = {0};
+
+    mesh_cache_header_t const header = {
+        .magic = MESH_CACHE_MAGIC,
+        .version = MESH_CACHE_VERSION,
+        .source_mod_time = (int64_t)GetFileModTime(model_path),
+        .source_size = (int64_t)GetFileLength(model_path),
+        .mesh_count = (uint32_t)model.meshCount,
+        .material_count = (uint32_t)model.materialCount};
+    blob_write(&writer, &header, sizeof(header));
+
+    for (int i = 0; i < model.materialCount; i++) {
+        mesh_cache_material_t m = {0};
+        for (int j = 0; j < MESH_CACHE_MATERIAL_MAPS; j++) {
+            m.colors[j] = model.materials[i].maps[j].color;
+            m.values[j] = model.materials[i].maps[j].value;
+        }
+        memcpy(m.params, model.materials[i].params, sizeof(m.params));
+
+        blob_write(&writer, &m, sizeof(m));
+    }
+
+    for (int i = 0; i < model.meshCount; i++)
+        mesh_cache_write_mesh(&writer, &model.meshes[i],
+                              model.meshMaterial[i]);
+
+    bool const ok =
+        SaveFileData(cache_path, writer.data, (unsigned int)writer.size);
+    RL_FREE(writer.data);
+
+    return ok;
+}
+
+Model load_model_cached(char const* model_path, bool* from_cache) {
+    Model model;
+    bool const cached = mesh_cache_load(model_path, &model);
+
+    if (from_cache != NULL)
+        *from_cache = cached;
+
+    if (cached)
+        return model;
+
+    // falling back to the source file, rebaking
+    // and loading the optimized meshes from the new cache
+    PROFILE_ZONE("load_model_obj");
+    double const start = profiler_time();
+    bool const baked = bake_model(model_path);
+    startup_report_add("obj", model_path, start,
+                       startup_asset_bytes(model_path));
+
+    if (baked && mesh_cache_load(model_path, &model))
+        return model;
+
+    // the cache can't be written, using the source as is
+    return LoadModel(model_path);
+}
+
+bool bake_model(char const* model_path) {
+    Model model = LoadModel(model_path);
+
+    // only the cpu-side data is split, optimized and saved,
+    // the uploaded buffers are dropped right after
+    Model parts = split_model_parts(&model, model_path);
+    optimize_model(&parts);
+
+    bool const ok = parts.meshCount > 0 && mesh_cache_save(model_path, parts);
+    if (ok)
+        TraceLog(LOG_INFO, "MESHCACHE: [%s] Baked %d meshes", model_path,
+                 parts.meshCount);
+    else
+        TraceLog(LOG_WARNING, "MESHCACHE: [%s] Failed to bake", model_path);
+
+    // the materials belong to the model
+    for (int i = 0; i < parts.meshCount; i++)
+        unload_mesh_cpu(parts.meshes[i]);
+
+    RL_FREE(parts.meshes);
+    RL_FREE(parts.meshMaterial);
+
+    UnloadModel(model);
+    return ok;
+}
@@ -0,0 +1,85 @@
+#ifndef SOURCE_MESHCACHE_C
+#define SOURCE_MESHCACHE_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+#define MESH_CACHE_MAGIC ((uint32_t)0x434D4452) // "RDMC" little-endian
+#define MESH_CACHE_VERSION ((uint32_t)5)
+#define MESH_CACHE_EXTENSION ((char const*)".mcache")
+#define MESH_CACHE_PATH_MAX_LENGTH ((int)256)
+// number of material maps whose color is baked
+// (MATERIAL_MAP_ALBEDO up to MATERIAL_MAP_BRDF)
+#define MESH_CACHE_MATERIAL_MAPS ((int)(MATERIAL_MAP_BRDF + 1))
+
+// which vertex streams are stored for a mesh
+#define MESH_STREAM_TEXCOORDS ((uint32_t)1 << 0)
+#define MESH_STREAM_TEXCOORDS2 ((uint32_t)1 << 1)
+#define MESH_STREAM_NORMALS ((uint32_t)1 << 2)
+#define MESH_STREAM_TANGENTS ((uint32_t)1 << 3)
+#define MESH_STREAM_COLORS ((uint32_t)1 << 4)
+#define MESH_STREAM_INDICES ((uint32_t)1 << 5)
+
+// layout of the blob, every field is little-endian:
+//   mesh_cache_header_t
+//   material_count * mesh_cache_material_t
+//   mesh_count * (mesh_cache_mesh_t, vertices, [streams by flag order])
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    // source obj identity, a mismatch means the cache is stale
+    int64_t source_mod_time;
+    int64_t source_size;
+    uint32_t mesh_count;
+    uint32_t material_count;
+} mesh_cache_header_t;
+
+typedef struct {
+    Color colors[MESH_CACHE_MATERIAL_MAPS];
+    float values[MESH_CACHE_MATERIAL_MAPS];
+    float params[4];
+} mesh_cache_material_t;
+
+typedef struct {
+    int32_t material;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+    uint32_t streams;
+} mesh_cache_mesh_t;
+
+// the caches are stored in host order, so they're only
+// valid on little-endian hosts (every platform we ship on)
+bool is_host_little_endian();
+
+// writes the cache path of a model (same name, cache extension) into buf
+void mesh_cache_path(char const* model_path, char* buf, int buf_size);
+
+// loads the model from its cache with a single read,
+// false when the cache is missing, stale or malformed
+bool mesh_cache_load(char const* model_path, Model* model);
+
+// same as mesh_cache_load but leaves the meshes cpu-side only,
+// safe to call from worker threads
+bool mesh_cache_load_cpu(char const* model_path, Model* model);
+
+// uploads the meshes of a model loaded cpu-side (gl thread only)
+void upload_model_meshes(Model* model);
+
+// frees a model loaded cpu-side and never uploaded
+void unload_model_cpu(Model model);
+void unload_mesh_cpu(Mesh mesh);
+
+// writes the cpu-side data of the model into its cache
+bool mesh_cache_save(char const* model_path, Model model);
+
+// loads the model from the cache when fresh,
+// otherwise parses the source file and rebakes the cache.
+// from_cache (optional) reports which path was taken
+Model load_model_cached(char const* model_path, bool* from_cache);
+
+// parses the source file, splits it into parts culled and picked
+// on their own, welds them into indexed meshes optimized
+// for the vertex cache and always rewrites the cache
+bool bake_model(char const* model_path);
+
+#endif
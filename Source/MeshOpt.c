@@ -0,0 +1,727 @@
+#include "MeshOpt.h"
+#include "MeshCache.h"
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+
+#define MESHOPT_MAX_STREAMS ((int)6)
+#define MESHOPT_MAX_OBJ_MATERIALS ((int)32)
+#define MESHOPT_MAX_OBJ_NAME ((int)128)
+#define MESHOPT_MAX_OBJ_PATH ((int)256)
+
+// a per-vertex attribute array of a mesh
+typedef struct {
+    void** data;
+    int stride;
+} vertex_stream_t;
+
+// collects the vertex attribute arrays the mesh has
+int mesh_vertex_streams(Mesh* mesh, vertex_stream_t* streams) {
+    vertex_stream_t const all[MESHOPT_MAX_STREAMS] = {
+        {(void**)&mesh->vertices, 3 * sizeof(float)},
+        {(void**)&mesh->texcoords, 2 * sizeof(float)},
+        {(void**)&mesh->texcoords2, 2 * sizeof(float)},
+        {(void**)&mesh->normals, 3 * sizeof(float)},
+        {(void**)&mesh->tangents, 4 * sizeof(float)},
+        {(void**)&mesh->colors, 4 * sizeof(unsigned char)}};
+
+    int count = 0;
+    for (int i = 0; i < MESHOPT_MAX_STREAMS; i++)
+        if (*all[i].data != NULL)
+            streams[count++] = all[i];
+
+    return count;
+}
+
+// rebuilds every stream so that new vertex i is old vertex sources[i]
+void mesh_gather_vertices(Mesh* mesh, int const* sources, int count) {
+    vertex_stream_t streams[MESHOPT_MAX_STREAMS];
+    int const stream_count = mesh_vertex_streams(mesh, streams);
+
+    for (int s = 0; s < stream_count; s++) {
+        uint8_t const* const old = *streams[s].data;
+        uint8_t* const gathered = RL_MALLOC((size_t)count * streams[s].stride);
+
+        for (int i = 0; i < count; i++)
+            memcpy(gathered + (size_t)i * streams[s].stride,
+                   old + (size_t)sources[i] * streams[s].stride,
+                   streams[s].stride);
+
+        RL_FREE(*streams[s].data);
+        *streams[s].data = gathered;
+    }
+
+    mesh->vertexCount = count;
+}
+
+uint32_t hash_bytes(uint8_t const* data, int size) {
+    // fnv-1a
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 16777619u;
+
+    return hash;
+}
+
+bool weld_mesh(Mesh* mesh) {
+    int const vertex_count = mesh->vertexCount;
+
+    // unindexed meshes have one vertex per triangle corner
+    if (mesh->indices != NULL || vertex_count <= 0 ||
+        vertex_count != mesh->triangleCount * 3)
+        return false;
+
+    vertex_stream_t streams[MESHOPT_MAX_STREAMS];
+    int const stream_count = mesh_vertex_streams(mesh, streams);
+
+    // interleaving every attribute, so that a vertex
+    // can be hashed and compared as a whole
+    int stride = 0;
+    for (int s = 0; s < stream_count; s++)
+        stride += streams[s].stride;
+
+    uint8_t* const packed = malloc((size_t)vertex_count * stride);
+    for (int v = 0; v < vertex_count; v++) {
+        int offset = 0;
+
+        for (int s = 0; s < stream_count; s++) {
+            memcpy(packed + (size_t)v * stride + offset,
+                   (uint8_t const*)*streams[s].data +
+                       (size_t)v * streams[s].stride,
+                   streams[s].stride);
+            offset += streams[s].stride;
+        }
+    }
+
+    // open addressing table of unique vertex indices
+    int table_size = 1;
+    while (table_size < vertex_count * 2)
+        table_size *= 2;
+
+    int* const table = malloc(sizeof(int) * table_size);
+    memset(table, -1, sizeof(int) * table_size);
+
+    // remap: corner -> unique vertex, uniques: unique vertex -> first corner
+    int* const remap = malloc(sizeof(int) * vertex_count);
+    int* const uniques = malloc(sizeof(int) * vertex_count);
+    int unique_count = 0;
+
+    for (int v = 0; v < vertex_count; v++) {
+        uint8_t const* const vertex = packed + (size_t)v * stride;
+        uint32_t slot = hash_bytes(vertex, stride) & (table_size - 1);
+
+        while (table[slot] >= 0 &&
+               memcmp(packed + (size_t)uniques[table[slot]] * stride, vertex,
+                      stride) != 0)
+            slot = (slot + 1) & (table_size - 1);
+
+        if (table[slot] < 0) {
+            table[slot] = unique_count;
+            uniques[unique_count++] = v;
+        }
+
+        remap[v] = table[slot];
+    }
+
+    bool const can_index = unique_count <= MESHOPT_MAX_INDEXED_VERTICES;
+
+    if (can_index) {
+        mesh->indices = RL_MALLOC(sizeof(unsigned short) * vertex_count);
+        for (int v = 0; v < vertex_count; v++)
+            mesh->indices[v] = (unsigned short)remap[v];
+
+        mesh_gather_vertices(mesh, uniques, unique_count);
+    }
+
+    free(uniques);
+    free(remap);
+    free(table);
+    free(packed);
+
+    return can_index;
+}
+
+// forsyth's vertex score, higher for vertices recently
+// used and for the ones with few triangles left
+float vertex_cache_score(int cache_position, int remaining_triangles) {
+    if (remaining_triangles == 0)
+        return -1;
+
+    float score = 0;
+
+    if (cache_position >= 0) {
+        // the last triangle's vertices get a fixed score,
+        // so that strips are not favoured over fans
+        if (cache_position < 3)
+            score = 0.75f;
+        else
+            score = powf(1 - (float)(cache_position - 3) /
+                                 (MESHOPT_CACHE_SIZE - 3),
+                         1.5f);
+    }
+
+    return score + 2 * powf((float)remaining_triangles, -0.5f);
+}
+
+void optimize_mesh_vertex_cache(Mesh* mesh) {
+    if (mesh->indices == NULL || mesh->triangleCount <= 0 ||
+        mesh->vertexCount <= 0)
+        return;
+
+    int const vertex_count = mesh->vertexCount;
+    int const triangle_count = mesh->triangleCount;
+    unsigned short const* const indices = mesh->indices;
+
+    // triangles of each vertex not emitted yet,
+    // vertex v owns adjacency[offsets[v] .. offsets[v] + remaining[v])
+    int* const remaining = calloc(vertex_count, sizeof(int));
+    int* const offsets = malloc(sizeof(int) * (vertex_count + 1));
+    int* const adjacency = malloc(sizeof(int) * triangle_count * 3);
+
+    for (int i = 0; i < triangle_count * 3; i++)
+        remaining[indices[i]]++;
+
+    offsets[0] = 0;
+    for (int v = 0; v < vertex_count; v++)
+        offsets[v + 1] = offsets[v] + remaining[v];
+
+    memset(remaining, 0, sizeof(int) * vertex_count);
+    for (int i = 0; i < triangle_count * 3; i++) {
+        int const v = indices[i];
+        adjacency[offsets[v] + remaining[v]++] = i / 3;
+    }
+
+    int* const cache_positions = malloc(sizeof(int) * vertex_count);
+    float* const vertex_scores = malloc(sizeof(float) * vertex_count);
+    float* const triangle_scores = malloc(sizeof(float) * triangle_count);
+    bool* const emitted = calloc(triangle_count, sizeof(bool));
+
+    for (int v = 0; v < vertex_count; v++) {
+        cache_positions[v] = -1;
+        vertex_scores[v] = vertex_cache_score(-1, remaining[v]);
+    }
+
+    int best = 0;
+    for (int t = 0; t < triangle_count; t++) {
+        triangle_scores[t] = vertex_scores[indices[t * 3]] +
+                             vertex_scores[indices[t * 3 + 1]] +
+                             vertex_scores[indices[t * 3 + 2]];
+
+        if (triangle_scores[t] > triangle_scores[best])
+            best = t;
+    }
+
+    unsigned short* const optimized =
+        RL_MALLOC(sizeof(unsigned short) * triangle_count * 3);
+    int cache[MESHOPT_CACHE_SIZE + 3];
+    int cache_count = 0;
+    int next_unemitted = 0;
+
+    for (int i = 0; i < triangle_count; i++) {
+        // no candidate in the cache, taking the first triangle left
+        if (best < 0) {
+            while (emitted[next_unemitted])
+                next_unemitted++;
+
+            best = next_unemitted;
+        }
+
+        emitted[best] = true;
+
+        int new_cache[MESHOPT_CACHE_SIZE + 3];
+        int new_cache_count = 0;
+
+        for (int c = 0; c < 3; c++) {
+            int const v = indices[best * 3 + c];
+            optimized[i * 3 + c] = (unsigned short)v;
+            new_cache[new_cache_count++] = v;
+
+            // the triangle is no longer pending for its vertices
+            int* const triangles = &adjacency[offsets[v]];
+            for (int j = 0; j < remaining[v]; j++) {
+                if (triangles[j] == best) {
+                    triangles[j] = triangles[--remaining[v]];
+                    break;
+                }
+            }
+        }
+
+        // the emitted vertices move to the front of the lru cache
+        for (int j = 0; j < cache_count; j++) {
+            int const v = cache[j];
+
+            if (v != new_cache[0] && v != new_cache[1] && v != new_cache[2])
+                new_cache[new_cache_count++] = v;
+        }
+
+        for (int j = 0; j < new_cache_count; j++) {
+            int const v = new_cache[j];
+            cache_positions[v] = j < MESHOPT_CACHE_SIZE ? j : -1;
+            vertex_scores[v] =
+                vertex_cache_score(cache_positions[v], remaining[v]);
+        }
+
+        // only the triangles touching the cache changed score
+        best = -1;
+        float best_score = -1;
+
+        for (int j = 0; j < new_cache_count; j++) {
+            int const v = new_cache[j];
+
+            for (int k = 0; k < remaining[v]; k++) {
+                int const t = adjacency[offsets[v] + k];
+                triangle_scores[t] = vertex_scores[indices[t * 3]] +
+                                     vertex_scores[indices[t * 3 + 1]] +
+                                     vertex_scores[indices[t * 3 + 2]];
+
+                if (triangle_scores[t] > best_score) {
+                    best_score = triangle_scores[t];
+                    best = t;
+                }
+            }
+        }
+
+        cache_count = new_cache_count < MESHOPT_CACHE_SIZE ? new_cache_count
+                                                           : MESHOPT_CACHE_SIZE;
+        memcpy(cache, new_cache, sizeof(int) * cache_count);
+    }
+
+    RL_FREE(mesh->indices);
+    mesh->indices = optimized;
+
+    free(emitted);
+    free(triangle_scores);
+    free(vertex_scores);
+    free(cache_positions);
+    free(adjacency);
+    free(offsets);
+    free(remaining);
+}
+
+void optimize_mesh_vertex_fetch(Mesh* mesh) {
+    if (mesh->indices == NULL)
+        return;
+
+    int const vertex_count = mesh->vertexCount;
+    int const index_count = mesh->triangleCount * 3;
+
+    // remap: old vertex -> new vertex, sources: new vertex -> old vertex
+    int* const remap = malloc(sizeof(int) * vertex_count);
+    int* const sources = malloc(sizeof(int) * vertex_count);
+    memset(remap, -1, sizeof(int) * vertex_count);
+    int next = 0;
+
+    for (int i = 0; i < index_count; i++) {
+        int const v = mesh->indices[i];
+
+        if (remap[v] < 0) {
+            remap[v] = next;
+            sources[next++] = v;
+        }
+
+        mesh->indices[i] = (unsigned short)remap[v];
+    }
+
+    // unreferenced vertices go last
+    for (int v = 0; v < vertex_count; v++)
+        if (remap[v] < 0)
+            sources[next++] = v;
+
+    mesh_gather_vertices(mesh, sources, vertex_count);
+
+    free(sources);
+    free(remap);
+}
+
+// material names of an obj's mtllib, in declaration order
+// (the order raylib gives the materials and their meshes)
+typedef struct {
+    char names[MESHOPT_MAX_OBJ_MATERIALS][MESHOPT_MAX_OBJ_NAME];
+    int count;
+} obj_materials_t;
+
+// next line of a text, the returned line is not terminated: its
+// length is written in length and the cursor moves past it
+char const* next_line(char const** cursor, int* length) {
+    char const* const line = *cursor;
+    if (*line == '\0')
+        return NULL;
+
+    char const* end = strchr(line, '\n');
+    if (end == NULL)
+        end = line + strlen(line);
+
+    *length = (int)(end - line);
+    *cursor = *end == '\0' ? end : end + 1;
+    return line;
+}
+
+// the line's keyword is key, its argument is written in arg (optional)
+bool line_keyword(char const* line, int length, char const* key, char* arg,
+                  int arg_size) {
+    while (length > 0 && isspace((unsigned char)*line)) {
+        line++;
+        length--;
+    }
+
+    int const key_length = (int)strlen(key);
+    if (length <= key_length || strncmp(line, key, key_length) != 0 ||
+        !isspace((unsigned char)line[key_length]))
+        return false;
+
+    if (arg != NULL) {
+        line += key_length;
+        length -= key_length;
+
+        while (length > 0 && isspace((unsigned char)*line)) {
+            line++;
+            length--;
+        }
+        while (length > 0 && isspace((unsigned char)line[length - 1]))
+            length--;
+
+        snprintf(arg, arg_size, "%.*s", length, line);
+    }
+
+    return true;
+}
+
+void load_obj_materials(char const* obj_path, char const* mtl_name,
+                        obj_materials_t* materials) {
+    char mtl_path[MESHOPT_MAX_OBJ_PATH];
+    snprintf(mtl_path, sizeof(mtl_path), "%s/%s", GetDirectoryPath(obj_path),
+             mtl_name);
+
+    char* const text = LoadFileText(mtl_path);
+    if (text == NULL)
+        return;
+
+    char const* cursor = text;
+    char const* line;
+    int length;
+
+    while ((line = next_line(&cursor, &length)) != NULL &&
+           materials->count < MESHOPT_MAX_OBJ_MATERIALS)
+        if (line_keyword(line, length, "newmtl",
+                         materials->names[materials->count],
+                         MESHOPT_MAX_OBJ_NAME))
+            materials->count++;
+
+    UnloadFileText(text);
+}
+
+// triangles of a face line: a polygon of n corners is fanned into n - 2
+int face_triangle_count(char const* line, int length) {
+    int tokens = 0;
+    bool in_token = false;
+
+    for (int i = 0; i < length; i++) {
+        bool const is_token = !isspace((unsigned char)line[i]);
+        if (is_token && !in_token)
+            tokens++;
+
+        in_token = is_token;
+    }
+
+    // the "f" keyword is a token too
+    int const corners = tokens - 1;
+    return corners >= 3 ? corners - 2 : 0;
+}
+
+// group (o/g statement) of every triangle of every mesh, in the order
+// raylib's obj loader lays them out: grouped by material, in file order.
+// false when the file doesn't match the model
+bool load_obj_triangle_groups(char const* obj_path, Model const* model,
+                              int** groups) {
+    char* const text = LoadFileText(obj_path);
+    if (text == NULL)
+        return false;
+
+    obj_materials_t materials = {0};
+    int* const filled = calloc(model->meshCount, sizeof(int));
+    int group = 0;
+    int mesh = 0;
+    bool ok = true;
+
+    char const* cursor = text;
+    char const* line;
+    int length;
+    char arg[MESHOPT_MAX_OBJ_NAME];
+
+    while (ok && (line = next_line(&cursor, &length)) != NULL) {
+        if (line_keyword(line, length, "o", NULL, 0) ||
+            line_keyword(line, length, "g", NULL, 0)) {
+            group++;
+        } else if (line_keyword(line, length, "mtllib", arg, sizeof(arg))) {
+            load_obj_materials(obj_path, arg, &materials);
+        } else if (line_keyword(line, length, "usemtl", arg, sizeof(arg))) {
+            // unknown materials end up in the first mesh
+            mesh = 0;
+            for (int m = 0; m < materials.count; m++)
+                if (strcmp(materials.names[m], arg) == 0)
+                    mesh = m;
+
+            ok = mesh < model->meshCount;
+        } else if (line_keyword(line, length, "f", NULL, 0)) {
+            int const count = face_triangle_count(line, length);
+            Mesh const* const target = &model->meshes[mesh];
+
+            ok = filled[mesh] + count <= target->triangleCount;
+            for (int t = 0; ok && t < count; t++)
+                groups[mesh][filled[mesh]++] = group;
+        }
+    }
+
+    for (int m = 0; ok && m < model->meshCount; m++)
+        ok = filled[m] == model->meshes[m].triangleCount;
+
+    free(filled);
+    UnloadFileText(text);
+    return ok;
+}
+
+// triangle of a mesh with its centroid coordinate along the split axis
+typedef struct {
+    float key;
+    int triangle;
+} part_triangle_t;
+
+int compare_part_triangles(void const* a, void const* b) {
+    float const x = ((part_triangle_t const*)a)->key;
+    float const y = ((part_triangle_t const*)b)->key;
+    return (x > y) - (x < y);
+}
+
+int mesh_corner(Mesh const* mesh, int triangle, int corner) {
+    int const i = triangle * 3 + corner;
+    return mesh->indices != NULL ? mesh->indices[i] : i;
+}
+
+Vector3 mesh_triangle_centroid(Mesh const* mesh, int triangle) {
+    Vector3 sum = {0};
+
+    for (int c = 0; c < 3; c++) {
+        float const* const v =
+            &mesh->vertices[mesh_corner(mesh, triangle, c) * 3];
+        sum = Vector3Add(sum, vec3(v[0], v[1], v[2]));
+    }
+
+    return Vector3Scale(sum, 1.0f / 3);
+}
+
+// new unindexed mesh made of the given triangles of the source
+Mesh gather_mesh_part(Mesh const* source, part_triangle_t const* triangles,
+                      int count) {
+    // shares the streams of the source until each is gathered
+    Mesh part = {.vertexCount = count * 3,
+                 .triangleCount = count,
+                 .vertices = source->vertices,
+                 .texcoords = source->texcoords,
+                 .texcoords2 = source->texcoords2,
+                 .normals = source->normals,
+                 .tangents = source->tangents,
+                 .colors = source->colors};
+
+    vertex_stream_t streams[MESHOPT_MAX_STREAMS];
+    int const stream_count = mesh_vertex_streams(&part, streams);
+
+    for (int s = 0; s < stream_count; s++) {
+        int const stride = streams[s].stride;
+        uint8_t const* const old = *streams[s].data;
+        uint8_t* const gathered = RL_MALLOC((size_t)part.vertexCount * stride);
+
+        for (int t = 0; t < count; t++)
+            for (int c = 0; c < 3; c++)
+                memcpy(gathered + (size_t)(t * 3 + c) * stride,
+                       old + (size_t)mesh_corner(source,
+                                                 triangles[t].triangle, c) *
+                                 stride,
+                       stride);
+
+        *streams[s].data = gathered;
+    }
+
+    return part;
+}
+
+typedef struct {
+    Mesh* meshes;
+    int* mesh_materials;
+    int count;
+    int capacity;
+} part_list_t;
+
+void part_list_push(part_list_t* list, Mesh mesh, int material) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        list->meshes = RL_REALLOC(list->meshes, sizeof(Mesh) * list->capacity);
+        list->mesh_materials =
+            RL_REALLOC(list->mesh_materials, sizeof(int) * list->capacity);
+    }
+
+    list->meshes[list->count] = mesh;
+    list->mesh_materials[list->count] = material;
+    list->count++;
+}
+
+// cuts the triangles in halves at the median centroid
+// along the longest axis, until the parts are small enough
+void split_mesh_part(Mesh const* source, int material,
+                     part_triangle_t* triangles, int count,
+                     part_list_t* parts) {
+    if (count <= MESHOPT_MAX_PART_TRIANGLES) {
+        part_list_push(parts, gather_mesh_part(source, triangles, count),
+                       material);
+        return;
+    }
+
+    Vector3 min = vec3(INFINITY, INFINITY, INFINITY);
+    Vector3 max = vec3(-INFINITY, -INFINITY, -INFINITY);
+
+    for (int t = 0; t < count; t++) {
+        Vector3 const c = mesh_triangle_centroid(source, triangles[t].triangle);
+        min = Vector3Min(min, c);
+        max = Vector3Max(max, c);
+    }
+
+    Vector3 const extent = Vector3Subtract(max, min);
+    int const axis = extent.x >= extent.y && extent.x >= extent.z ? 0
+                     : extent.y >= extent.z                      ? 1
+                                                                 : 2;
+
+    for (int t = 0; t < count; t++) {
+        Vector3 const c = mesh_triangle_centroid(source, triangles[t].triangle);
+        triangles[t].key = axis == 0 ? c.x : axis == 1 ? c.y : c.z;
+    }
+
+    qsort(triangles, count, sizeof(part_triangle_t), compare_part_triangles);
+
+    int const half = count / 2;
+    split_mesh_part(source, material, triangles, half, parts);
+    split_mesh_part(source, material, triangles + half, count - half, parts);
+}
+
+Model split_model_parts(Model const* model, char const* obj_path) {
+    int** const groups = malloc(sizeof(int*) * model->meshCount);
+    for (int m = 0; m < model->meshCount; m++)
+        groups[m] = calloc(model->meshes[m].triangleCount + 1, sizeof(int));
+
+    if (!load_obj_triangle_groups(obj_path, model, groups)) {
+        TraceLog(LOG_WARNING,
+                 "MESHOPT: [%s] Obj groups don't match the meshes, "
+                 "splitting spatially only",
+                 obj_path);
+
+        for (int m = 0; m < model->meshCount; m++)
+            memset(groups[m], 0, sizeof(int) * model->meshes[m].triangleCount);
+    }
+
+    part_list_t parts = {0};
+
+    for (int m = 0; m < model->meshCount; m++) {
+        Mesh const* const mesh = &model->meshes[m];
+        part_triangle_t* const triangles =
+            malloc(sizeof(part_triangle_t) * (mesh->triangleCount + 1));
+
+        for (int t = 0; t < mesh->triangleCount; t++)
+            triangles[t] = (part_triangle_t){.triangle = t};
+
+        // every run of triangles of a same group is a part
+        int start = 0;
+        for (int t = 1; t <= mesh->triangleCount; t++) {
+            if (t < mesh->triangleCount && groups[m][t] == groups[m][start])
+                continue;
+
+            split_mesh_part(mesh, model->meshMaterial[m], triangles + start,
+                            t - start, &parts);
+            start = t;
+        }
+
+        free(triangles);
+        free(groups[m]);
+    }
+
+    free(groups);
+
+    Model split = *model;
+    split.meshes = parts.meshes;
+    split.meshMaterial = parts.mesh_materials;
+    split.meshCount = parts.count;
+
+    TraceLog(LOG_INFO, "MESHOPT: [%s] Split %d meshes into %d parts",
+             obj_path, model->meshCount, split.meshCount);
+
+    return split;
+}
+
+// cuts the unindexed meshes with more vertices than an index can
+// address into runs of whole triangles, each small enough to be welded
+void chunk_model_meshes(Model* model) {
+    int const max_triangles = MESHOPT_MAX_INDEXED_VERTICES / 3;
+    part_list_t chunks = {0};
+    bool is_chunked = false;
+
+    for (int m = 0; m < model->meshCount; m++) {
+        Mesh const mesh = model->meshes[m];
+        int const material = model->meshMaterial[m];
+
+        if (mesh.indices != NULL || mesh.triangleCount <= max_triangles) {
+            part_list_push(&chunks, mesh, material);
+            continue;
+        }
+
+        part_triangle_t* const triangles =
+            malloc(sizeof(part_triangle_t) * mesh.triangleCount);
+        for (int t = 0; t < mesh.triangleCount; t++)
+            triangles[t] = (part_triangle_t){.triangle = t};
+
+        // the triangles are in file order, so the runs stay mostly local
+        for (int t = 0; t < mesh.triangleCount; t += max_triangles) {
+            int const count = mesh.triangleCount - t < max_triangles
+                                  ? mesh.triangleCount - t
+                                  : max_triangles;
+            part_list_push(&chunks,
+                           gather_mesh_part(&mesh, triangles + t, count),
+                           material);
+        }
+
+        TraceLog(LOG_INFO,
+                 "MESHOPT: Mesh %d of %d triangles cut into %d chunks", m,
+                 mesh.triangleCount,
+                 (mesh.triangleCount + max_triangles - 1) / max_triangles);
+
+        free(triangles);
+        unload_mesh_cpu(mesh);
+        is_chunked = true;
+    }
+
+    if (!is_chunked) {
+        RL_FREE(chunks.meshes);
+        RL_FREE(chunks.mesh_materials);
+        return;
+    }
+
+    RL_FREE(model->meshes);
+    RL_FREE(model->meshMaterial);
+    model->meshes = chunks.meshes;
+    model->meshMaterial = chunks.mesh_materials;
+    model->meshCount = chunks.count;
+}
+
+void optimize_model(Model* model) {
+    chunk_model_meshes(model);
+
+    for (int i = 0; i < model->meshCount; i++) {
+        Mesh* const mesh = &model->meshes[i];
+        int const expanded_count = mesh->vertexCount;
+
+        if (!weld_mesh(mesh))
+            continue;
+
+        optimize_mesh_vertex_cache(mesh);
+        optimize_mesh_vertex_fetch(mesh);
+
+        TraceLog(LOG_INFO, "MESHOPT: Mesh %d welded from %d to %d vertices",
+                 i, expanded_count, mesh->vertexCount);
+    }
+}
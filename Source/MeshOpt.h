@@ -0,0 +1,39 @@
+#ifndef SOURCE_MESHOPT_C
+#define SOURCE_MESHOPT_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// simulated post-transform cache of the vertex cache optimization
+#define MESHOPT_CACHE_SIZE ((int)32)
+// indices are unsigned short, bigger meshes are cut into chunks
+#define MESHOPT_MAX_INDEXED_VERTICES ((int)65535)
+// parts bigger than this are cut into spatial clusters,
+// so that a long part can still be partly culled
+#define MESHOPT_MAX_PART_TRIANGLES ((int)4096)
+
+// welds the identical vertices of an unindexed mesh (cpu side only)
+// into an indexed one. false when the mesh is already indexed or
+// has too many unique vertices to be indexed
+bool weld_mesh(Mesh* mesh);
+
+// reorders the triangles of an indexed mesh for post-transform
+// vertex cache locality (Forsyth's linear-speed algorithm)
+void optimize_mesh_vertex_cache(Mesh* mesh);
+
+// reorders the vertices of an indexed mesh in order of first use,
+// for pre-transform fetch locality
+void optimize_mesh_vertex_fetch(Mesh* mesh);
+
+// all of the above on every mesh of the model (cpu side only), the
+// unindexed meshes of more than MESHOPT_MAX_INDEXED_VERTICES vertices
+// are first cut into chunks that can be indexed
+void optimize_model(Model* model);
+
+// splits the meshes of a model loaded from an obj file into parts:
+// one per o/g group, cut further into spatial clusters when bigger
+// than MESHOPT_MAX_PART_TRIANGLES. the parts are new unindexed
+// cpu-side meshes, the materials are shared with the model
+Model split_model_parts(Model const* model, char const* obj_path);
+
+#endif
@@ -0,0 +1,251 @@
+#include "PostFx.h"
+#include "Profiler.h"
+#include "Culling.h"
+
+blur_chain_t load_blur_chain(int width, int height) {
+    blur_chain_t chain;
+    for (int i = 0; i < 2; i++) {
+        chain.targets[i] = LoadRenderTexture(width, height);
+        SetTextureFilter(chain.targets[i].texture, TEXTURE_FILTER_BILINEAR);
+    }
+
+    return chain;
+}
+
+void unload_blur_chain(blur_chain_t chain) {
+    for (int i = 0; i < 2; i++)
+        UnloadRenderTexture(chain.targets[i]);
+}
+
+// LoadRenderTexture, with a depth texture instead of a renderbuffer
+RenderTexture2D load_render_texture_depth(int width, int height) {
+    RenderTexture2D target = {0};
+    target.id = rlLoadFramebuffer(width, height);
+
+    rlEnableFramebuffer(target.id);
+    target.texture = (Texture2D){
+        .id = rlLoadTexture(NULL, width, height,
+                            PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1),
+        .width = width,
+        .height = height,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    // raylib has no pixel format for depth, 19 is the one of its examples
+    target.depth = (Texture2D){.id = rlLoadTextureDepth(width, height, false),
+                               .width = width,
+                               .height = height,
+                               .mipmaps = 1,
+                               .format = 19};
+
+    rlFramebufferAttach(target.id, target.texture.id,
+                        RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D,
+                        0);
+    rlFramebufferAttach(target.id, target.depth.id, RL_ATTACHMENT_DEPTH,
+                        RL_ATTACHMENT_TEXTURE2D, 0);
+
+    if (!rlFramebufferComplete(target.id))
+        TraceLog(LOG_WARNING, "POSTFX: Scene framebuffer is not complete");
+
+    rlDisableFramebuffer();
+    return target;
+}
+
+void init_post_fx(post_fx_t* post, int width, int height) {
+    post->scene = load_render_texture_depth(width, height);
+    post->resolved = LoadRenderTexture(width, height);
+    post->half = load_blur_chain(width / 2, height / 2);
+    post->quarter = load_blur_chain(width / 4, height / 4);
+
+    Image const black = GenImageColor(1, 1, BLACK);
+    post->black = LoadTextureFromImage(black);
+    UnloadImage(black);
+
+    post->emission_shader = LoadShader(NULL, POST_FX_EMISSION_SHADER_PATH);
+    // so that DrawMesh binds the material's emission map
+    post->emission_shader.locs[SHADER_LOC_MAP_EMISSION] =
+        GetShaderLocation(post->emission_shader, "emissionMap");
+    post->emission_threshold_loc =
+        GetShaderLocation(post->emission_shader, "threshold");
+
+    post->blur_shader = LoadShader(NULL, POST_FX_BLUR_SHADER_PATH);
+    post->blur_direction_loc =
+        GetShaderLocation(post->blur_shader, "direction");
+
+    post->bloom_shader = LoadShader(NULL, POST_FX_BLOOM_SHADER_PATH);
+    post->bloom_half_loc = GetShaderLocation(post->bloom_shader, "bloomHalf");
+    post->bloom_quarter_loc =
+        GetShaderLocation(post->bloom_shader, "bloomQuarter");
+    post->bloom_intensity_loc =
+        GetShaderLocation(post->bloom_shader, "intensity");
+
+    // the kernel steps a texel of the actual scene size
+    post->outline_shader = LoadShader(NULL, POST_FX_OUTLINE_SHADER_PATH);
+    Vector2 const resolution = vec2(width, height);
+    SetShaderValue(post->outline_shader,
+                   GetShaderLocation(post->outline_shader, "resolution"),
+                   &resolution, SHADER_UNIFORM_VEC2);
+
+    float const threshold = POST_FX_BLOOM_THRESHOLD;
+    SetShaderValue(post->emission_shader, post->emission_threshold_loc,
+                   &threshold, SHADER_UNIFORM_FLOAT);
+    float const intensity = POST_FX_BLOOM_INTENSITY;
+    SetShaderValue(post->bloom_shader, post->bloom_intensity_loc, &intensity,
+                   SHADER_UNIFORM_FLOAT);
+
+    post->has_bloom = false;
+}
+
+void deinit_post_fx(post_fx_t* post) {
+    UnloadRenderTexture(post->scene);
+    UnloadRenderTexture(post->resolved);
+    unload_blur_chain(post->half);
+    unload_blur_chain(post->quarter);
+    UnloadTexture(post->black);
+    UnloadShader(post->emission_shader);
+    UnloadShader(post->blur_shader);
+    UnloadShader(post->bloom_shader);
+    UnloadShader(post->outline_shader);
+}
+
+void post_fx_begin_scene(post_fx_t* post) {
+    BeginTextureMode(post->scene);
+}
+
+void post_fx_end_scene(post_fx_t* post) {
+    (void)post;
+    EndTextureMode();
+}
+
+bool model_has_emission(Model model) {
+    for (int i = 0; i < model.materialCount; i++)
+        if (model.materials[i].maps[MATERIAL_MAP_EMISSION].texture.id > 0)
+            return true;
+
+    return false;
+}
+
+void post_fx_draw_emission(post_fx_t* post, Camera3D camera, Model model,
+                           bool const* visible, Vector3 pos, float scale,
+                           Color tint) {
+    PROFILE_ZONE("post_fx_draw_emission");
+
+    // the maps are shared with the model, so
+    // the swaps are undone right after the draw
+    Shader shaders[model.materialCount];
+    Texture2D emissions[model.materialCount];
+
+    for (int i = 0; i < model.materialCount; i++) {
+        MaterialMap* const emission =
+            &model.materials[i].maps[MATERIAL_MAP_EMISSION];
+
+        shaders[i] = model.materials[i].shader;
+        emissions[i] = emission->texture;
+        model.materials[i].shader = post->emission_shader;
+        if (emission->texture.id == 0)
+            emission->texture = post->black;
+    }
+
+    // the half resolution target is the bright pass
+    BeginTextureMode(post->half.targets[0]);
+        ClearBackground(BLACK);
+
+        BeginMode3D(camera);
+            draw_model_visible(model, visible, pos, scale, tint);
+        EndMode3D();
+    EndTextureMode();
+
+    for (int i = 0; i < model.materialCount; i++) {
+        model.materials[i].shader = shaders[i];
+        model.materials[i].maps[MATERIAL_MAP_EMISSION].texture = emissions[i];
+    }
+
+    post->has_bloom = true;
+}
+
+// draws the whole source into the whole target, render
+// textures are stored upside down, hence the negative height
+void blit(Texture2D source, RenderTexture2D target) {
+    BeginTextureMode(target);
+        DrawTexturePro(source,
+                       rect(vec2(0, 0), vec2(source.width, -source.height)),
+                       rect(vec2(0, 0),
+                            vec2(target.texture.width, target.texture.height)),
+                       vec2(0, 0), 0, WHITE);
+    EndTextureMode();
+}
+
+// separable gaussian, horizontally into the scratch
+// target and vertically back into the first one
+void post_fx_blur(post_fx_t* post, blur_chain_t* chain) {
+    Texture2D const texture = chain->targets[0].texture;
+    Vector2 const directions[2] = {vec2(1.0f / texture.width, 0),
+                                   vec2(0, 1.0f / texture.height)};
+
+    for (int i = 0; i < 2; i++) {
+        SetShaderValue(post->blur_shader, post->blur_direction_loc,
+                       &directions[i], SHADER_UNIFORM_VEC2);
+
+        BeginShaderMode(post->blur_shader);
+            blit(chain->targets[i].texture, chain->targets[1 - i]);
+        EndShaderMode();
+    }
+}
+
+void post_fx_bloom(post_fx_t* post) {
+    PROFILE_ZONE("post_fx_bloom");
+
+    // bilinear 2x downsample for the wider glow
+    blit(post->half.targets[0].texture, post->quarter.targets[0]);
+
+    post_fx_blur(post, &post->half);
+    post_fx_blur(post, &post->quarter);
+}
+
+void post_fx_composite(post_fx_t* post, Rectangle source) {
+    Texture2D const scene = post->scene.texture;
+
+    if (!post->has_bloom) {
+        DrawTextureRec(scene, source, vec2(0, 0), WHITE);
+        return;
+    }
+
+    BeginShaderMode(post->bloom_shader);
+        SetShaderValueTexture(post->bloom_shader, post->bloom_half_loc,
+                              post->half.targets[0].texture);
+        SetShaderValueTexture(post->bloom_shader, post->bloom_quarter_loc,
+                              post->quarter.targets[0].texture);
+        DrawTextureRec(scene, source, vec2(0, 0), WHITE);
+    EndShaderMode();
+
+    post->has_bloom = false;
+}
+
+void post_fx_resolve(post_fx_t* post) {
+    PROFILE_ZONE("post_fx_resolve");
+
+    Rectangle const source = rect(
+        vec2(0, 0), vec2(post->scene.texture.width, -post->scene.texture.height));
+
+    // texture modes don't nest, the blur passes go first
+    if (post->has_bloom)
+        post_fx_bloom(post);
+
+    BeginTextureMode(post->resolved);
+        post_fx_composite(post, source);
+
+        // blended over the composite, only the edge pixels are written
+        BeginShaderMode(post->outline_shader);
+            DrawTextureRec(post->scene.depth, source, vec2(0, 0),
+                           POST_FX_OUTLINE_COLOR);
+        EndShaderMode();
+    EndTextureMode();
+}
+
+void post_fx_present(post_fx_t* post) {
+    PROFILE_ZONE("post_fx_present");
+
+    Texture2D const resolved = post->resolved.texture;
+    DrawTextureRec(resolved,
+                   rect(vec2(0, 0), vec2(resolved.width, -resolved.height)),
+                   vec2(0, 0), WHITE);
+}
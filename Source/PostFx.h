@@ -0,0 +1,77 @@
+#ifndef SOURCE_POSTFX_C
+#define SOURCE_POSTFX_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+#define POST_FX_EMISSION_SHADER_PATH ((char const*)"Res/Shaders/Emission.fs")
+#define POST_FX_BLUR_SHADER_PATH ((char const*)"Res/Shaders/Blur.fs")
+#define POST_FX_BLOOM_SHADER_PATH ((char const*)"Res/Shaders/Bloom.fs")
+#define POST_FX_OUTLINE_SHADER_PATH ((char const*)"Res/Shaders/Sobel.fs")
+
+// emission under this brightness doesn't glow
+#define POST_FX_BLOOM_THRESHOLD ((float)0.1)
+#define POST_FX_BLOOM_INTENSITY ((float)1.6)
+
+#define POST_FX_OUTLINE_COLOR ((Color){255, 255, 255, 255})
+
+// a render target and its scratch twin, for the two blur directions
+typedef struct {
+    RenderTexture2D targets[2];
+} blur_chain_t;
+
+// the 3d pass is drawn offscreen into scene, then composited
+// into the backbuffer. the bloom is sourced from the emission maps
+// only, drawn straight into the half resolution chain. the outline
+// is found on the scene's depth, wherever the geometry ends
+typedef struct {
+    // its depth is a texture, sampled by the outline
+    RenderTexture2D scene;
+    // the post-processed scene, kept until the next resolve
+    // so that unchanged frames only present it again
+    RenderTexture2D resolved;
+    // half and quarter resolution bloom, targets[0] holds the result
+    blur_chain_t half;
+    blur_chain_t quarter;
+    // emission map of the materials without one
+    Texture2D black;
+
+    Shader emission_shader;
+    int emission_threshold_loc;
+    Shader blur_shader;
+    int blur_direction_loc;
+    Shader bloom_shader;
+    int bloom_half_loc;
+    int bloom_quarter_loc;
+    int bloom_intensity_loc;
+    Shader outline_shader;
+
+    // something emissive was drawn this frame
+    bool has_bloom;
+} post_fx_t;
+
+void init_post_fx(post_fx_t* post, int width, int height);
+void deinit_post_fx(post_fx_t* post);
+
+// the 3d pass goes between these two
+void post_fx_begin_scene(post_fx_t* post);
+void post_fx_end_scene(post_fx_t* post);
+
+// whether any material of the model has an emission map
+bool model_has_emission(Model model);
+
+// draws the emission maps of the model into the bloom source,
+// the rest of the model only occludes. the meshes not flagged
+// visible are skipped (null draws every mesh)
+void post_fx_draw_emission(post_fx_t* post, Camera3D camera, Model model,
+                           bool const* visible, Vector3 pos, float scale,
+                           Color tint);
+
+// blurs the bloom source (if any emission was drawn), composites
+// it with the scene into the resolved target and outlines it
+void post_fx_resolve(post_fx_t* post);
+
+// draws the last resolved scene into the current framebuffer
+void post_fx_present(post_fx_t* post);
+
+#endif
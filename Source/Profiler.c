@@ -0,0 +1,224 @@
+#define _POSIX_C_SOURCE 199309L
+#include "Profiler.h"
+#include <pthread.h>
+#include <time.h>
+#include <string.h>
+
+typedef struct {
+    profile_zone_t zones[PROFILER_CAPACITY];
+    // total zones ever recorded, the ring index is head % capacity
+    uint64_t head;
+    int thread_count;
+    bool enabled;
+
+    // zones recorded in the last closed frame
+    uint64_t frame_first;
+    uint64_t last_frame_first;
+    uint64_t last_frame_last;
+    double frame_start;
+    double last_frame_start;
+    double last_frame_end;
+} profiler_t;
+
+profiler_t profiler = {0};
+
+// profiler id of the calling thread, -1 until its first zone
+__thread int profiler_thread = -1;
+// nesting of the open zones of the calling thread
+__thread int profiler_depth = 0;
+
+double profiler_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void profiler_set_enabled(bool enabled) {
+    profiler.enabled = enabled;
+
+    if (enabled)
+        profiler.frame_start = profiler_time();
+}
+
+bool profiler_is_enabled() {
+    return profiler.enabled;
+}
+
+int profiler_current_thread() {
+    if (profiler_thread < 0)
+        profiler_thread =
+            __atomic_fetch_add(&profiler.thread_count, 1, __ATOMIC_RELAXED);
+
+    return profiler_thread;
+}
+
+profile_scope_t profile_scope_begin(char const* name) {
+    if (!profiler.enabled)
+        return (profile_scope_t){.name = NULL, .start = 0};
+
+    profiler_depth++;
+    return (profile_scope_t){.name = name, .start = profiler_time()};
+}
+
+void profile_scope_end(profile_scope_t const* scope) {
+    // the zone began while disabled
+    if (scope->name == NULL)
+        return;
+
+    double const end = profiler_time();
+    profiler_depth--;
+
+    uint64_t const index =
+        __atomic_fetch_add(&profiler.head, 1, __ATOMIC_RELAXED);
+    profiler.zones[index % PROFILER_CAPACITY] =
+        (profile_zone_t){.name = scope->name,
+                         .start = scope->start,
+                         .end = end,
+                         .thread = profiler_current_thread(),
+                         .depth = profiler_depth};
+}
+
+void profiler_frame_mark() {
+    if (!profiler.enabled)
+        return;
+
+    uint64_t const head = __atomic_load_n(&profiler.head, __ATOMIC_RELAXED);
+    double const now = profiler_time();
+
+    profiler.last_frame_first = profiler.frame_first;
+    profiler.last_frame_last = head;
+    profiler.last_frame_start = profiler.frame_start;
+    profiler.last_frame_end = now;
+
+    profiler.frame_first = head;
+    profiler.frame_start = now;
+}
+
+// the zones of a frame sharing a name and depth
+typedef struct {
+    char const* name;
+    int depth;
+    // of the first one
+    double start;
+    double duration;
+    int count;
+} profile_zone_sum_t;
+
+int compare_zone_sums_by_start(void const* a, void const* b) {
+    double const x = ((profile_zone_sum_t const*)a)->start;
+    double const y = ((profile_zone_sum_t const*)b)->start;
+    return (x > y) - (x < y);
+}
+
+int compare_zone_sums_by_duration(void const* a, void const* b) {
+    double const x = ((profile_zone_sum_t const*)a)->duration;
+    double const y = ((profile_zone_sum_t const*)b)->duration;
+    return (x < y) - (x > y);
+}
+
+void profile_zone_sum_add(profile_zone_sum_t* sums, int* count,
+                          profile_zone_t const* zone) {
+    for (int i = 0; i < *count; i++) {
+        profile_zone_sum_t* const sum = &sums[i];
+
+        if (sum->depth == zone->depth && strcmp(sum->name, zone->name) == 0) {
+            sum->start = fmin(sum->start, zone->start);
+            sum->duration += zone->end - zone->start;
+            sum->count++;
+            return;
+        }
+    }
+
+    if (*count < PROFILER_OVERLAY_MAX_KINDS)
+        sums[(*count)++] = (profile_zone_sum_t){.name = zone->name,
+                                                .depth = zone->depth,
+                                                .start = zone->start,
+                                                .duration =
+                                                    zone->end - zone->start,
+                                                .count = 1};
+}
+
+void profiler_draw_overlay(Font font, Vector2 pos) {
+    static profile_zone_sum_t zones[PROFILER_OVERLAY_MAX_KINDS];
+    int count = 0;
+    int const thread = profiler_current_thread();
+
+    // zones are recorded when they close, children before their
+    // parents, so the whole frame is summed before anything is dropped
+    uint64_t first = profiler.last_frame_first;
+    if (profiler.last_frame_last - first > PROFILER_CAPACITY)
+        first = profiler.last_frame_last - PROFILER_CAPACITY;
+
+    for (uint64_t i = first; i < profiler.last_frame_last; i++) {
+        profile_zone_t const zone = profiler.zones[i % PROFILER_CAPACITY];
+
+        if (zone.thread == thread)
+            profile_zone_sum_add(zones, &count, &zone);
+    }
+
+    // a parent lasts at least as long as its children, keeping
+    // the longest keeps the top of the tree, then shown in order
+    qsort(zones, count, sizeof(profile_zone_sum_t),
+          compare_zone_sums_by_duration);
+    if (count > PROFILER_OVERLAY_MAX_ZONES)
+        count = PROFILER_OVERLAY_MAX_ZONES;
+    qsort(zones, count, sizeof(profile_zone_sum_t), compare_zone_sums_by_start);
+
+    double const frame_duration =
+        profiler.last_frame_end - profiler.last_frame_start;
+    float const line_height = PROFILER_OVERLAY_FONT_SIZE + 4;
+    float const bar_width = 160;
+    float const indent = 12;
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "frame %.2f ms", frame_duration * 1000);
+    DrawTextEx(font, buf, pos, PROFILER_OVERLAY_FONT_SIZE, 1, GRAY);
+
+    for (int i = 0; i < count; i++) {
+        double const duration = zones[i].duration;
+        Vector2 const line_pos = vec2(pos.x + zones[i].depth * indent,
+                                      pos.y + line_height * (i + 1));
+
+        // share of the frame taken by the zone
+        float const share =
+            frame_duration > 0 ? (float)(duration / frame_duration) : 0;
+        DrawRectangleV(line_pos, vec2(bar_width * share, line_height - 4),
+                       color(200, 120, 65, 120));
+
+        if (zones[i].count > 1)
+            snprintf(buf, sizeof(buf), "%s x%d %.3f ms", zones[i].name,
+                     zones[i].count, duration * 1000);
+        else
+            snprintf(buf, sizeof(buf), "%s %.3f ms", zones[i].name,
+                     duration * 1000);
+        DrawTextEx(font, buf, line_pos, PROFILER_OVERLAY_FONT_SIZE, 1, WHITE);
+    }
+}
+
+bool profiler_dump_trace(char const* path) {
+    FILE* const file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+
+    uint64_t const head = __atomic_load_n(&profiler.head, __ATOMIC_RELAXED);
+    uint64_t const first = head > PROFILER_CAPACITY ? head - PROFILER_CAPACITY
+                                                    : 0;
+
+    // complete events ("ph": "X"), timestamps in microseconds
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (uint64_t i = first; i < head; i++) {
+        profile_zone_t const zone = profiler.zones[i % PROFILER_CAPACITY];
+
+        fprintf(file,
+                "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                "\"pid\":0,\"tid\":%d}%s\n",
+                zone.name, zone.start * 1e6, (zone.end - zone.start) * 1e6,
+                zone.thread, i + 1 < head ? "," : "");
+    }
+    fprintf(file, "]}\n");
+
+    fclose(file);
+    TraceLog(LOG_INFO, "PROFILER: [%s] Dumped %d zones", path,
+             (int)(head - first));
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef SOURCE_PROFILER_C
+#define SOURCE_PROFILER_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// compile with -DPROFILER=0 to strip every zone out of the build
+#ifndef PROFILER
+    #define PROFILER 1
+#endif
+
+// zones kept in the ring buffer, the oldest get overwritten
+#define PROFILER_CAPACITY ((int)(1 << 16))
+#define PROFILER_OVERLAY_MAX_ZONES ((int)24)
+// distinct zones (name and depth) a frame is summed into for the overlay
+#define PROFILER_OVERLAY_MAX_KINDS ((int)256)
+#define PROFILER_OVERLAY_FONT_SIZE ((float)18)
+#define PROFILER_TRACE_PATH ((char const*)"trace.json")
+
+typedef struct {
+    char const* name;
+    // seconds, from profiler_time
+    double start;
+    double end;
+    int thread;
+    int depth;
+} profile_zone_t;
+
+// open zone, closed when it goes out of scope
+typedef struct {
+    char const* name;
+    double start;
+} profile_scope_t;
+
+#if PROFILER
+    #define PROFILE_CONCAT_(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+    // times the rest of the enclosing block
+    #define PROFILE_ZONE(name)                                        \
+        profile_scope_t const PROFILE_CONCAT(profile_scope_, __LINE__) \
+            __attribute__((cleanup(profile_scope_end))) =             \
+                profile_scope_begin(name)
+#else
+    #define PROFILE_ZONE(name) ((void)0)
+#endif
+
+// monotonic high resolution clock in seconds, usable without a window
+double profiler_time();
+
+// recording is off by default, a disabled zone costs a branch
+void profiler_set_enabled(bool enabled);
+bool profiler_is_enabled();
+
+profile_scope_t profile_scope_begin(char const* name);
+void profile_scope_end(profile_scope_t const* scope);
+
+// closes the current frame, the overlay shows the last closed one
+void profiler_frame_mark();
+
+// draws the zones of the last frame of the calling thread, the zones of
+// the same name and depth summed, the longest PROFILER_OVERLAY_MAX_ZONES
+void profiler_draw_overlay(Font font, Vector2 pos);
+
+// writes the ring buffer as chrome trace json (chrome://tracing)
+bool profiler_dump_trace(char const* path);
+
+#endif
@@ -0,0 +1,167 @@
+#include "SoftFrame.h"
+#include "Streaming.h"
+#include "Profiler.h"
+
+void init_soft_frame(soft_frame_t* frame, ctx_t* ctx, int width, int height,
+                     int worker_count) {
+    *frame = (soft_frame_t){.weapon_count = ctx->weapons.count};
+    init_soft_target(&frame->target, width, height, worker_count);
+
+    frame->weapon_textures =
+        calloc(frame->weapon_count, sizeof(*frame->weapon_textures));
+    frame->is_weapon_texture_loaded =
+        calloc(frame->weapon_count, sizeof(*frame->is_weapon_texture_loaded));
+
+    // the same atlas as ctx->font's, only its bytes are kept
+    Image atlas;
+    Font const font = load_font_sdf_cpu(FONT_PATH, &atlas, NULL);
+    frame->font_atlas = load_soft_texture(atlas);
+    UnloadFontData(font.glyphs, font.glyphCount);
+    RL_FREE(font.recs);
+    UnloadImage(atlas);
+}
+
+void deinit_soft_frame(soft_frame_t* frame) {
+    for (int i = 0; i < frame->weapon_count; i++)
+        unload_soft_texture(frame->weapon_textures[i]);
+
+    unload_soft_texture(frame->font_atlas);
+    free(frame->weapon_textures);
+    free(frame->is_weapon_texture_loaded);
+    deinit_soft_target(&frame->target);
+}
+
+// the base color of the weapon, null when it has none
+soft_texture_t const* soft_frame_weapon_texture(soft_frame_t* frame,
+                                                ctx_t* ctx, int weapon) {
+    if (!frame->is_weapon_texture_loaded[weapon]) {
+        // the top level of the cache the gpu samples, bc1/bc3
+        // blocks decoded back so that both renderers see the same texels
+        char const* const path =
+            ctx->weapons.descs[weapon].texture_paths[WEAPON_TEXTURE_BASE_COLOR];
+
+        if (path != NULL) {
+            Image image = load_image_cached(path, 0, NULL, NULL);
+
+            if (decode_bc_image(&image))
+                frame->weapon_textures[weapon] = load_soft_texture(image);
+
+            UnloadImage(image);
+        }
+
+        frame->is_weapon_texture_loaded[weapon] = true;
+    }
+
+    soft_texture_t const* const texture = &frame->weapon_textures[weapon];
+    return texture->pixels != NULL ? texture : NULL;
+}
+
+// what ctx_draw_current_weapon draws, the same level
+// of detail or crossfade for the target's height
+void soft_draw_ctx_weapon(soft_frame_t* frame, ctx_t* ctx) {
+    PROFILE_ZONE("soft_draw_ctx_weapon");
+
+    int const weapon = ctx->selected_weapon;
+    if (!ctx_is_weapon_resident(ctx, weapon))
+        return;
+
+    soft_target_t* const target = &frame->target;
+    Model const model = ctx_cur_weapon(ctx);
+    float const scale = ctx_cur_weapon_scale(ctx);
+    uint8_t const model_alpha = ctx_cur_weapon_alpha(ctx);
+    Vector3 const pos = scalar_to_vec3(0);
+
+    // same transform as DrawModel
+    Matrix const transform = MatrixMultiply(
+        model.transform,
+        MatrixMultiply(MatrixScale(scale, scale, scale),
+                       MatrixTranslate(pos.x, pos.y, pos.z)));
+    Matrix const mvp = soft_camera_mvp(ctx->camera, transform, target->width,
+                                       target->height);
+
+    soft_texture_t const* const texture =
+        soft_frame_weapon_texture(frame, ctx, weapon);
+    soft_material_t material = {.shader = SOFT_SHADER_DEFAULT,
+                                .depth_test = true,
+                                .cull_back_faces = true};
+    Mesh const* meshes = NULL;
+    int mesh_count = 0;
+
+    if (model_alpha == 255) {
+        model_lods_t const* const lods = &ctx->weapons.lods[weapon];
+        int const level =
+            select_lod(lods, ctx->camera, pos, scale, target->height);
+
+        meshes = lods->meshes[level];
+        mesh_count = lods->mesh_count;
+    } else {
+        model_wireframe_t const* const wireframe =
+            ctx_cur_weapon_wireframe(ctx);
+
+        material.shader = SOFT_SHADER_CROSSFADE;
+        material.wire_color = color(255, 255, 255, 255 - model_alpha);
+        material.wire_width = WIREFRAME_LINE_WIDTH;
+        meshes = wireframe->meshes;
+        mesh_count = wireframe->mesh_count;
+    }
+
+    for (int i = 0; i < mesh_count; i++) {
+        int const mesh_material = model.meshMaterial[i];
+        // the weapon's textures are bound to its first material only,
+        // the meshes of the others draw untextured as on the gpu
+        material.texture = mesh_material == 0 ? texture : NULL;
+
+        // the tint of DrawModel, the diffuse color times the solid color
+        Color const diffuse =
+            model.materials[mesh_material].maps[MATERIAL_MAP_DIFFUSE].color;
+        material.tint = color(diffuse.r, diffuse.g, diffuse.b,
+                              diffuse.a * model_alpha / 255);
+
+        soft_draw_mesh(target, &meshes[i], mvp, &material);
+    }
+}
+
+// what ui_draw draws, the hud in a single mesh
+void soft_draw_ctx_hud(soft_frame_t* frame, ctx_t* ctx) {
+    PROFILE_ZONE("soft_draw_ctx_hud");
+
+    soft_target_t* const target = &frame->target;
+    Mesh const mesh = ui_cpu_mesh(&ctx->ui);
+    soft_material_t const material = {.shader = SOFT_SHADER_UI,
+                                      .texture = &frame->font_atlas,
+                                      .tint = WHITE};
+
+    soft_draw_mesh(target, &mesh, soft_screen_mvp(target->width, target->height),
+                   &material);
+}
+
+void soft_draw_ctx(soft_frame_t* frame, ctx_t* ctx) {
+    soft_clear(&frame->target, BACKGROUND_COLOR);
+    soft_draw_ctx_weapon(frame, ctx);
+    soft_draw_ctx_hud(frame, ctx);
+}
+
+void soft_ctx_internal_update(ctx_t* ctx, soft_frame_t* frame) {
+    double const start_time = profiler_time();
+
+    double const frame_time =
+        ctx->is_input_scripted ? ctx->sim_tick : GetFrameTime();
+    ctx_simulate(ctx, frame_time);
+
+    ctx_update(ctx);
+    double const update_time = profiler_time();
+
+    soft_clear(&frame->target, BACKGROUND_COLOR);
+    soft_draw_ctx_weapon(frame, ctx);
+    double const draw_3d_time = profiler_time();
+
+    ctx_update_hud(ctx);
+    soft_draw_ctx_hud(frame, ctx);
+    double const ui_time = profiler_time();
+
+    ctx->timings = (frame_timings_t){.update = update_time - start_time,
+                                     .draw_3d = draw_3d_time - update_time,
+                                     .ui = ui_time - draw_3d_time};
+
+    profiler_frame_mark();
+}
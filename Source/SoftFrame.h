@@ -0,0 +1,34 @@
+#ifndef SOURCE_SOFTFRAME_C
+#define SOURCE_SOFTFRAME_C
+
+#include "Context.h"
+#include "SoftRaster.h"
+
+// the frames of a ctx rendered on the cpu: the weapon (levels of
+// detail or solid/wire crossfade) and the hud, without post-processing
+typedef struct {
+    soft_target_t target;
+    // base color of each catalogue weapon, decoded from the
+    // texture cache the first time the weapon is drawn
+    soft_texture_t* weapon_textures;
+    bool* is_weapon_texture_loaded;
+    int weapon_count;
+    // distance field atlas of ctx_t.font
+    soft_texture_t font_atlas;
+} soft_frame_t;
+
+// worker_count <= 0 means one per hardware thread. everything is
+// loaded cpu side (font and texture caches), no gl context is needed
+// and the ctx can be a cpu only one (init_ctx_cpu)
+void init_soft_frame(soft_frame_t* frame, ctx_t* ctx, int width, int height,
+                     int worker_count);
+void deinit_soft_frame(soft_frame_t* frame);
+
+// draws the current state of the ctx into frame->target
+void soft_draw_ctx(soft_frame_t* frame, ctx_t* ctx);
+
+// a frame of ctx_internal_update drawn by the soft target
+// instead of gl (the timings' present stays 0)
+void soft_ctx_internal_update(ctx_t* ctx, soft_frame_t* frame);
+
+#endif
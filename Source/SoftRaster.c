@@ -0,0 +1,888 @@
+#include "SoftRaster.h"
+#include "Profiler.h"
+#include <string.h>
+#include <math.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// 4 lanes of floats, sse2 where available
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+
+    typedef __m128 f4_t;
+
+    f4_t f4_set1(float x) { return _mm_set1_ps(x); }
+    f4_t f4_setr(float a, float b, float c, float d) {
+        return _mm_setr_ps(a, b, c, d);
+    }
+    f4_t f4_add(f4_t a, f4_t b) { return _mm_add_ps(a, b); }
+    f4_t f4_mul(f4_t a, f4_t b) { return _mm_mul_ps(a, b); }
+    f4_t f4_div(f4_t a, f4_t b) { return _mm_div_ps(a, b); }
+    f4_t f4_load(float const* p) { return _mm_loadu_ps(p); }
+    void f4_store(float* p, f4_t a) { _mm_storeu_ps(p, a); }
+    f4_t f4_sub(f4_t a, f4_t b) { return _mm_sub_ps(a, b); }
+    f4_t f4_min(f4_t a, f4_t b) { return _mm_min_ps(a, b); }
+    f4_t f4_max(f4_t a, f4_t b) { return _mm_max_ps(a, b); }
+    // exact under 2^31
+    f4_t f4_floor(f4_t a) {
+        f4_t const t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1)));
+    }
+    // truncated towards zero
+    void f4_store_int(int* p, f4_t a) {
+        _mm_storeu_si128((__m128i*)p, _mm_cvttps_epi32(a));
+    }
+    // comparisons return a bit per lane
+    int f4_ge(f4_t a, f4_t b) { return _mm_movemask_ps(_mm_cmpge_ps(a, b)); }
+    int f4_gt(f4_t a, f4_t b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+    int f4_lt(f4_t a, f4_t b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+
+    // the channels of 4 colors, one f4 per channel (0 to 255)
+    void f4_unpack_colors(Color const* colors, f4_t channels[4]) {
+        __m128i const packed = _mm_loadu_si128((__m128i const*)colors);
+        __m128i const byte = _mm_set1_epi32(0xff);
+
+        for (int k = 0; k < 4; k++)
+            channels[k] = _mm_cvtepi32_ps(_mm_and_si128(
+                _mm_srl_epi32(packed, _mm_cvtsi32_si128(k * 8)), byte));
+    }
+
+    // rounds channels (0 to 255) into the colors of the mask's lanes
+    void f4_pack_colors(f4_t const channels[4], int mask, Color* colors) {
+        __m128i packed = _mm_setzero_si128();
+
+        for (int k = 0; k < 4; k++)
+            packed = _mm_or_si128(
+                packed,
+                _mm_sll_epi32(_mm_cvttps_epi32(
+                                  _mm_add_ps(channels[k], _mm_set1_ps(0.5f))),
+                              _mm_cvtsi32_si128(k * 8)));
+
+        __m128i const keep =
+            _mm_setr_epi32(-(mask & 1), -((mask >> 1) & 1),
+                           -((mask >> 2) & 1), -((mask >> 3) & 1));
+        __m128i const previous = _mm_loadu_si128((__m128i const*)colors);
+        _mm_storeu_si128((__m128i*)colors,
+                         _mm_or_si128(_mm_and_si128(keep, packed),
+                                      _mm_andnot_si128(keep, previous)));
+    }
+#else
+    typedef struct {
+        float v[4];
+    } f4_t;
+
+    f4_t f4_set1(float x) { return (f4_t){{x, x, x, x}}; }
+    f4_t f4_setr(float a, float b, float c, float d) {
+        return (f4_t){{a, b, c, d}};
+    }
+    f4_t f4_add(f4_t a, f4_t b) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] += b.v[i];
+        return a;
+    }
+    f4_t f4_mul(f4_t a, f4_t b) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] *= b.v[i];
+        return a;
+    }
+    f4_t f4_div(f4_t a, f4_t b) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] /= b.v[i];
+        return a;
+    }
+    f4_t f4_sub(f4_t a, f4_t b) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] -= b.v[i];
+        return a;
+    }
+    f4_t f4_min(f4_t a, f4_t b) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    f4_t f4_max(f4_t a, f4_t b) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    f4_t f4_floor(f4_t a) {
+        for (int i = 0; i < 4; i++)
+            a.v[i] = floorf(a.v[i]);
+        return a;
+    }
+    void f4_store_int(int* p, f4_t a) {
+        for (int i = 0; i < 4; i++)
+            p[i] = (int)a.v[i];
+    }
+    f4_t f4_load(float const* p) { return (f4_t){{p[0], p[1], p[2], p[3]}}; }
+    void f4_store(float* p, f4_t a) { memcpy(p, a.v, sizeof(a.v)); }
+    int f4_ge(f4_t a, f4_t b) {
+        int mask = 0;
+        for (int i = 0; i < 4; i++)
+            mask |= (a.v[i] >= b.v[i]) << i;
+        return mask;
+    }
+    int f4_gt(f4_t a, f4_t b) {
+        int mask = 0;
+        for (int i = 0; i < 4; i++)
+            mask |= (a.v[i] > b.v[i]) << i;
+        return mask;
+    }
+    int f4_lt(f4_t a, f4_t b) {
+        int mask = 0;
+        for (int i = 0; i < 4; i++)
+            mask |= (a.v[i] < b.v[i]) << i;
+        return mask;
+    }
+
+    void f4_unpack_colors(Color const* colors, f4_t channels[4]) {
+        for (int i = 0; i < 4; i++) {
+            channels[0].v[i] = colors[i].r;
+            channels[1].v[i] = colors[i].g;
+            channels[2].v[i] = colors[i].b;
+            channels[3].v[i] = colors[i].a;
+        }
+    }
+
+    void f4_pack_colors(f4_t const channels[4], int mask, Color* colors) {
+        for (int i = 0; i < 4; i++)
+            if (mask & (1 << i))
+                colors[i] = (Color){(uint8_t)(channels[0].v[i] + 0.5f),
+                                    (uint8_t)(channels[1].v[i] + 0.5f),
+                                    (uint8_t)(channels[2].v[i] + 0.5f),
+                                    (uint8_t)(channels[3].v[i] + 0.5f)};
+    }
+#endif
+
+// a triangle corner before projection
+typedef struct {
+    Vector4 clip;
+    float uv[2];
+    float color[4];
+} soft_vertex_t;
+
+// the triangles of a batch, written from out
+typedef struct {
+    soft_target_t* target;
+    Mesh const* mesh;
+    Matrix mvp;
+    int first;
+    int count;
+    soft_triangle_t* out;
+    int out_count;
+} soft_batch_job_t;
+
+typedef struct {
+    soft_target_t* target;
+    int tile;
+} soft_tile_job_t;
+
+soft_texture_t load_soft_texture(Image image) {
+    Image copy = ImageCopy(image);
+    ImageFormat(&copy, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    if (copy.data == NULL || copy.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        UnloadImage(copy);
+        return (soft_texture_t){0};
+    }
+
+    return (soft_texture_t){.width = copy.width,
+                            .height = copy.height,
+                            .pixels = copy.data};
+}
+
+void unload_soft_texture(soft_texture_t texture) {
+    RL_FREE(texture.pixels);
+}
+
+void init_soft_target(soft_target_t* target, int width, int height,
+                      int worker_count) {
+    *target = (soft_target_t){.width = width,
+                              .height = height,
+                              .stride = (width + 3) & ~3};
+
+    // the last pixel group of a row is loaded whole
+    size_t const pixels = (size_t)target->stride * height;
+    target->color = calloc(pixels, sizeof(Color));
+    target->depth = calloc(pixels, sizeof(float));
+
+    target->tiles_x = (width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    target->tiles_y = (height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    target->bins = calloc(target->tiles_x * target->tiles_y, sizeof(soft_bin_t));
+
+    init_jobs(&target->jobs, worker_count);
+}
+
+void deinit_soft_target(soft_target_t* target) {
+    deinit_jobs(&target->jobs);
+
+    for (int i = 0; i < target->tiles_x * target->tiles_y; i++)
+        free(target->bins[i].triangles);
+
+    free(target->bins);
+    free(target->clip);
+    free(target->triangles);
+    free(target->depth);
+    free(target->color);
+}
+
+void soft_clear(soft_target_t* target, Color color) {
+    size_t const pixels = (size_t)target->stride * target->height;
+
+    for (size_t i = 0; i < pixels; i++) {
+        target->color[i] = color;
+        target->depth[i] = 1;
+    }
+
+    target->drawn_triangles = 0;
+}
+
+Matrix soft_camera_mvp(Camera3D camera, Matrix transform, int width,
+                       int height) {
+    // same matrices as BeginMode3D and DrawMesh
+    Matrix const view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix const projection =
+        MatrixPerspective(camera.fovy * DEG2RAD, (double)width / height,
+                          RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+
+    return MatrixMultiply(MatrixMultiply(transform, view), projection);
+}
+
+Matrix soft_screen_mvp(int width, int height) {
+    return MatrixOrtho(0, width, height, 0, 0, 1);
+}
+
+Image soft_target_image(soft_target_t const* target) {
+    Image const image = {.data = RL_MALLOC((size_t)target->width *
+                                           target->height * sizeof(Color)),
+                         .width = target->width,
+                         .height = target->height,
+                         .mipmaps = 1,
+                         .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+
+    for (int y = 0; y < target->height; y++)
+        memcpy((Color*)image.data + (size_t)y * target->width,
+               target->color + (size_t)y * target->stride,
+               sizeof(Color) * target->width);
+
+    return image;
+}
+
+// vertex stage, clip space positions of a batch of vertices
+void soft_transform_job(void* arg) {
+    soft_batch_job_t* const job = arg;
+    Matrix const m = job->mvp;
+    float const* const positions = job->mesh->vertices;
+
+    for (int v = job->first; v < job->first + job->count; v++) {
+        float const x = positions[v * 3];
+        float const y = positions[v * 3 + 1];
+        float const z = positions[v * 3 + 2];
+
+        job->target->clip[v] = (Vector4){
+            m.m0 * x + m.m4 * y + m.m8 * z + m.m12,
+            m.m1 * x + m.m5 * y + m.m9 * z + m.m13,
+            m.m2 * x + m.m6 * y + m.m10 * z + m.m14,
+            m.m3 * x + m.m7 * y + m.m11 * z + m.m15};
+    }
+}
+
+soft_vertex_t soft_corner(soft_target_t const* target, Mesh const* mesh,
+                          int corner) {
+    int const v = mesh->indices != NULL ? mesh->indices[corner] : corner;
+    soft_vertex_t vertex = {.clip = target->clip[v],
+                            .color = {1, 1, 1, 1}};
+
+    if (mesh->texcoords != NULL) {
+        vertex.uv[0] = mesh->texcoords[v * 2];
+        vertex.uv[1] = mesh->texcoords[v * 2 + 1];
+    }
+
+    if (mesh->colors != NULL)
+        for (int i = 0; i < 4; i++)
+            vertex.color[i] = mesh->colors[v * 4 + i] / 255.0f;
+
+    return vertex;
+}
+
+soft_vertex_t soft_vertex_lerp(soft_vertex_t const* a, soft_vertex_t const* b,
+                               float t) {
+    soft_vertex_t r;
+    r.clip = (Vector4){a->clip.x + (b->clip.x - a->clip.x) * t,
+                       a->clip.y + (b->clip.y - a->clip.y) * t,
+                       a->clip.z + (b->clip.z - a->clip.z) * t,
+                       a->clip.w + (b->clip.w - a->clip.w) * t};
+
+    for (int i = 0; i < 2; i++)
+        r.uv[i] = a->uv[i] + (b->uv[i] - a->uv[i]) * t;
+
+    for (int i = 0; i < 4; i++)
+        r.color[i] = a->color[i] + (b->color[i] - a->color[i]) * t;
+
+    return r;
+}
+
+// the plane through the values at the 3 screen points
+void soft_plane(float plane[3], Vector2 const p[3], float const values[3],
+                float inv_area) {
+    float const d1 = values[1] - values[0];
+    float const d2 = values[2] - values[0];
+
+    plane[0] = (d1 * (p[2].y - p[0].y) - d2 * (p[1].y - p[0].y)) * inv_area;
+    plane[1] = (d2 * (p[1].x - p[0].x) - d1 * (p[2].x - p[0].x)) * inv_area;
+    plane[2] = values[0] - plane[0] * p[0].x - plane[1] * p[0].y;
+}
+
+// projects a triangle in front of the near plane and sets it up,
+// false when culled or off screen
+bool soft_setup_triangle(soft_target_t const* target,
+                         soft_vertex_t const corners[3],
+                         soft_triangle_t* triangle) {
+    Vector2 p[3];
+    float depths[3];
+    float inv_ws[3];
+
+    for (int i = 0; i < 3; i++) {
+        Vector4 const c = corners[i].clip;
+        inv_ws[i] = 1 / c.w;
+        p[i] = vec2((c.x * inv_ws[i] * 0.5f + 0.5f) * target->width,
+                    (0.5f - c.y * inv_ws[i] * 0.5f) * target->height);
+        depths[i] = c.z * inv_ws[i] * 0.5f + 0.5f;
+    }
+
+    // counter clockwise in ndc is clockwise on screen (y down)
+    float const area = (p[1].x - p[0].x) * (p[2].y - p[0].y) -
+                       (p[2].x - p[0].x) * (p[1].y - p[0].y);
+
+    if (area == 0 || (target->material.cull_back_faces && area > 0))
+        return false;
+
+    float const min_x = fminf(p[0].x, fminf(p[1].x, p[2].x));
+    float const min_y = fminf(p[0].y, fminf(p[1].y, p[2].y));
+    float const max_x = fmaxf(p[0].x, fmaxf(p[1].x, p[2].x));
+    float const max_y = fmaxf(p[0].y, fmaxf(p[1].y, p[2].y));
+
+    // pixel centers covered by the bounds
+    triangle->min_x = MAX((int)ceilf(min_x - 0.5f), 0);
+    triangle->min_y = MAX((int)ceilf(min_y - 0.5f), 0);
+    triangle->max_x = MIN((int)floorf(max_x - 0.5f), target->width - 1);
+    triangle->max_y = MIN((int)floorf(max_y - 0.5f), target->height - 1);
+
+    if (triangle->min_x > triangle->max_x || triangle->min_y > triangle->max_y)
+        return false;
+
+    // the edge opposite each corner
+    float const sign = area < 0 ? -1 : 1;
+    for (int i = 0; i < 3; i++) {
+        Vector2 const a = p[(i + 1) % 3];
+        Vector2 const b = p[(i + 2) % 3];
+        float* const e = triangle->edges[i];
+
+        e[0] = -(b.y - a.y) * sign;
+        e[1] = (b.x - a.x) * sign;
+        e[2] = ((b.y - a.y) * a.x - (b.x - a.x) * a.y) * sign;
+        // inside to the right, or below a horizontal edge
+        triangle->top_left[i] = e[0] > 0 || (e[0] == 0 && e[1] > 0);
+    }
+
+    float const inv_area = 1 / area;
+    soft_plane(triangle->planes[SOFT_PLANE_DEPTH], p, depths, inv_area);
+    soft_plane(triangle->planes[SOFT_PLANE_INV_W], p, inv_ws, inv_area);
+
+    for (int k = 0; k < 2; k++) {
+        float const values[3] = {corners[0].uv[k] * inv_ws[0],
+                                 corners[1].uv[k] * inv_ws[1],
+                                 corners[2].uv[k] * inv_ws[2]};
+        soft_plane(triangle->planes[SOFT_PLANE_U + k], p, values, inv_area);
+    }
+
+    for (int k = 0; k < 4; k++) {
+        float const values[3] = {corners[0].color[k] * inv_ws[0],
+                                 corners[1].color[k] * inv_ws[1],
+                                 corners[2].color[k] * inv_ws[2]};
+        soft_plane(triangle->planes[SOFT_PLANE_COLOR + k], p, values,
+                   inv_area);
+    }
+
+    // the 2d draws are affine, the texcoord steps are constant
+    float const du = triangle->planes[SOFT_PLANE_U][0] * target->texture_width;
+    float const dv =
+        triangle->planes[SOFT_PLANE_U + 1][0] * target->texture_height;
+    triangle->texel_footprint = sqrtf(du * du + dv * dv);
+
+    return true;
+}
+
+// primitive stage: clipping against the near plane, culling and setup
+void soft_setup_job(void* arg) {
+    soft_batch_job_t* const job = arg;
+    job->out_count = 0;
+
+    for (int t = job->first; t < job->first + job->count; t++) {
+        soft_vertex_t corners[3];
+        float distances[3];
+        int inside = 0;
+
+        for (int i = 0; i < 3; i++) {
+            corners[i] = soft_corner(job->target, job->mesh, t * 3 + i);
+            // gl's near plane, z >= -w
+            distances[i] = corners[i].clip.z + corners[i].clip.w;
+            inside += distances[i] >= 0;
+        }
+
+        if (inside == 0)
+            continue;
+
+        // sutherland-hodgman on the near plane, a quad at most
+        soft_vertex_t polygon[4];
+        int count = 0;
+
+        for (int i = 0; i < 3; i++) {
+            int const j = (i + 1) % 3;
+
+            if (distances[i] >= 0)
+                polygon[count++] = corners[i];
+
+            if ((distances[i] >= 0) != (distances[j] >= 0))
+                polygon[count++] = soft_vertex_lerp(
+                    &corners[i], &corners[j],
+                    distances[i] / (distances[i] - distances[j]));
+        }
+
+        for (int i = 1; i + 1 < count; i++) {
+            soft_vertex_t const fan[3] = {polygon[0], polygon[i],
+                                          polygon[i + 1]};
+
+            if (soft_setup_triangle(job->target, fan,
+                                    &job->out[job->out_count]))
+                job->out_count++;
+        }
+    }
+}
+
+float soft_plane_at(float const plane[3], float x, float y) {
+    return plane[0] * x + plane[1] * y + plane[2];
+}
+
+// bilinear samples of the mask's lanes with repeat wrapping, one f4
+// per channel (0 to 1), white without a texture. the other lanes'
+// coordinates may be anything (outside the triangle), they're not read
+void soft_sample4(soft_texture_t const* texture, f4_t u, f4_t v, int mask,
+                  f4_t out[4]) {
+    if (texture == NULL || texture->pixels == NULL) {
+        for (int k = 0; k < 4; k++)
+            out[k] = f4_set1(1);
+        return;
+    }
+
+    f4_t const width = f4_set1((float)texture->width);
+    f4_t const height = f4_set1((float)texture->height);
+    f4_t const x = f4_sub(f4_mul(u, width), f4_set1(0.5f));
+    f4_t const y = f4_sub(f4_mul(v, height), f4_set1(0.5f));
+    f4_t const fx = f4_floor(x);
+    f4_t const fy = f4_floor(y);
+    f4_t const tx = f4_sub(x, fx);
+    f4_t const ty = f4_sub(y, fy);
+
+    // the top left texels wrapped into the texture,
+    // the others being at most one texel past its edges
+    int x0[4];
+    int y0[4];
+    f4_store_int(x0, f4_sub(fx, f4_mul(width, f4_floor(f4_div(fx, width)))));
+    f4_store_int(y0, f4_sub(fy, f4_mul(height, f4_floor(f4_div(fy, height)))));
+
+    // corners in bilinear order, then lanes
+    Color corners[4][4] = {{{0}}};
+
+    for (int lane = 0; lane < 4; lane++) {
+        if ((mask & (1 << lane)) == 0)
+            continue;
+
+        // coordinates too far to be wrapped exactly
+        int const left = x0[lane] >= 0 && x0[lane] < texture->width ? x0[lane] : 0;
+        int const top = y0[lane] >= 0 && y0[lane] < texture->height ? y0[lane] : 0;
+        int const right = left + 1 < texture->width ? left + 1 : 0;
+        int const bottom = top + 1 < texture->height ? top + 1 : 0;
+        Color const* const row0 = &texture->pixels[top * texture->width];
+        Color const* const row1 = &texture->pixels[bottom * texture->width];
+
+        corners[0][lane] = row0[left];
+        corners[1][lane] = row0[right];
+        corners[2][lane] = row1[left];
+        corners[3][lane] = row1[right];
+    }
+
+    f4_t const one = f4_set1(1);
+    f4_t const sx = f4_sub(one, tx);
+    f4_t const sy = f4_sub(one, ty);
+    f4_t const weights[4] = {f4_mul(sx, sy), f4_mul(tx, sy), f4_mul(sx, ty),
+                             f4_mul(tx, ty)};
+
+    for (int k = 0; k < 4; k++)
+        out[k] = f4_set1(0);
+
+    for (int corner = 0; corner < 4; corner++) {
+        f4_t texels[4];
+        f4_unpack_colors(corners[corner], texels);
+
+        for (int k = 0; k < 4; k++)
+            out[k] = f4_add(out[k], f4_mul(texels[k], weights[corner]));
+    }
+
+    for (int k = 0; k < 4; k++)
+        out[k] = f4_mul(out[k], f4_set1(1 / 255.0f));
+}
+
+float soft_smoothstep(float edge0, float edge1, float x) {
+    float const t = Clamp((x - edge0) / (edge1 - edge0), 0, 1);
+    return t * t * (3 - 2 * t);
+}
+
+// the fragment of the material's shader, texel being the sample
+// of the material's texture at uv. false to discard it
+bool soft_shade(soft_target_t const* target, soft_triangle_t const* triangle,
+                float const uv[2], Vector4 texel, float const color[4],
+                float inv_w, float px, float py, Vector4* out) {
+    soft_material_t const* const material = &target->material;
+    Vector4 const tint = ColorNormalize(material->tint);
+
+    switch (material->shader) {
+        case SOFT_SHADER_DEFAULT: {
+            *out = (Vector4){texel.x * tint.x * color[0],
+                             texel.y * tint.y * color[1],
+                             texel.z * tint.z * color[2],
+                             texel.w * tint.w * color[3]};
+            return true;
+        }
+
+        case SOFT_SHADER_CROSSFADE: {
+            Vector4 const solid = {texel.x * tint.x, texel.y * tint.y,
+                                   texel.z * tint.z, texel.w * tint.w};
+            Vector4 const wire_color = ColorNormalize(material->wire_color);
+
+            // fwidth of the barycentrics, the analytic derivative
+            // of the perspective-correct interpolation
+            float edge = 0;
+            for (int k = 0; k < 3; k++) {
+                float const* const plane =
+                    triangle->planes[SOFT_PLANE_COLOR + k];
+                float const* const w_plane =
+                    triangle->planes[SOFT_PLANE_INV_W];
+                float const p = soft_plane_at(plane, px, py);
+                float const ddx =
+                    (plane[0] * inv_w - p * w_plane[0]) / (inv_w * inv_w);
+                float const ddy =
+                    (plane[1] * inv_w - p * w_plane[1]) / (inv_w * inv_w);
+                float const width = fmaxf(
+                    (fabsf(ddx) + fabsf(ddy)) * material->wire_width, 1e-4f);
+                float const coverage = soft_smoothstep(0, width, color[k]);
+
+                edge = fmaxf(edge, 1 - coverage);
+            }
+
+            float const wire = wire_color.w * edge;
+            float const alpha = wire + solid.w * (1 - wire);
+
+            if (alpha <= 0)
+                return false;
+
+            float const solid_weight = solid.w * (1 - wire);
+            *out = (Vector4){
+                (wire_color.x * wire + solid.x * solid_weight) / alpha,
+                (wire_color.y * wire + solid.y * solid_weight) / alpha,
+                (wire_color.z * wire + solid.z * solid_weight) / alpha, alpha};
+            return true;
+        }
+
+        case SOFT_SHADER_UI: {
+            float coverage = 1;
+
+            if (uv[0] >= 0) {
+                float const distance = texel.x - 0.5f;
+                float const width = fmaxf(
+                    SOFT_SDF_DISTANCE_PER_TEXEL * triangle->texel_footprint,
+                    1e-4f);
+
+                coverage = soft_smoothstep(-width, width, distance);
+            }
+
+            *out = (Vector4){color[0] * tint.x, color[1] * tint.y,
+                             color[2] * tint.z, color[3] * coverage * tint.w};
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// BLEND_ALPHA of 4 fragments (one f4 per channel) over
+// the pixels of the mask's lanes, rgb and alpha alike
+void soft_blend4(Color* dst, f4_t const src[4], int mask) {
+    f4_t const zero = f4_set1(0);
+    f4_t const one = f4_set1(1);
+    f4_t const a = f4_min(f4_max(src[3], zero), one);
+    f4_t const src_weight = f4_mul(a, f4_set1(255));
+    f4_t const dst_weight = f4_sub(one, a);
+
+    f4_t channels[4];
+    f4_unpack_colors(dst, channels);
+
+    for (int k = 0; k < 4; k++)
+        channels[k] =
+            f4_add(f4_mul(f4_min(f4_max(src[k], zero), one), src_weight),
+                   f4_mul(channels[k], dst_weight));
+
+    f4_pack_colors(channels, mask, dst);
+}
+
+void soft_rasterize(soft_target_t* target, soft_triangle_t const* triangle,
+                    int tile_x0, int tile_y0, int tile_x1, int tile_y1) {
+    int const x0 = MAX(triangle->min_x, tile_x0) & ~3;
+    int const x1 = MIN(triangle->max_x, tile_x1);
+    int const y0 = MAX(triangle->min_y, tile_y0);
+    int const y1 = MIN(triangle->max_y, tile_y1);
+    int const first_x = MAX(triangle->min_x, tile_x0);
+    bool const depth_test = target->material.depth_test;
+
+    f4_t const lanes = f4_setr(0.5f, 1.5f, 2.5f, 3.5f);
+    f4_t const zero = f4_set1(0);
+    f4_t edge_a[3];
+    for (int i = 0; i < 3; i++)
+        edge_a[i] = f4_set1(triangle->edges[i][0]);
+
+    float const* const depth_plane = triangle->planes[SOFT_PLANE_DEPTH];
+    float const* const w_plane = triangle->planes[SOFT_PLANE_INV_W];
+
+    for (int y = y0; y <= y1; y++) {
+        float const py = y + 0.5f;
+        f4_t row[3];
+        for (int i = 0; i < 3; i++)
+            row[i] = f4_set1(triangle->edges[i][1] * py +
+                             triangle->edges[i][2]);
+
+        for (int x = x0; x <= x1; x += 4) {
+            f4_t const px = f4_add(f4_set1((float)x), lanes);
+
+            // lanes inside the tile's part of the bounds
+            int mask = 0;
+            for (int lane = 0; lane < 4; lane++)
+                mask |= (x + lane >= first_x && x + lane <= x1) << lane;
+
+            for (int i = 0; i < 3 && mask != 0; i++) {
+                f4_t const e = f4_add(f4_mul(edge_a[i], px), row[i]);
+                mask &= triangle->top_left[i] ? f4_ge(e, zero)
+                                              : f4_gt(e, zero);
+            }
+
+            if (mask == 0)
+                continue;
+
+            size_t const offset = (size_t)y * target->stride + x;
+            f4_t const z = f4_add(f4_mul(f4_set1(depth_plane[0]), px),
+                                  f4_set1(depth_plane[1] * py + depth_plane[2]));
+
+            if (depth_test)
+                mask &= f4_lt(z, f4_load(&target->depth[offset]));
+
+            if (mask == 0)
+                continue;
+
+            // perspective-correct attributes of the 4 pixels
+            f4_t const inv_w = f4_add(f4_mul(f4_set1(w_plane[0]), px),
+                                      f4_set1(w_plane[1] * py + w_plane[2]));
+            f4_t const w = f4_div(f4_set1(1), inv_w);
+            float attributes[SOFT_PLANE_COUNT][4];
+
+            f4_store(attributes[SOFT_PLANE_DEPTH], z);
+            f4_store(attributes[SOFT_PLANE_INV_W], inv_w);
+            for (int k = SOFT_PLANE_U; k < SOFT_PLANE_COUNT; k++) {
+                float const* const plane = triangle->planes[k];
+                f4_t const value =
+                    f4_add(f4_mul(f4_set1(plane[0]), px),
+                           f4_set1(plane[1] * py + plane[2]));
+                f4_store(attributes[k], f4_mul(value, w));
+            }
+
+            f4_t samples[4];
+            float texels[4][4];
+            soft_sample4(target->material.texture,
+                         f4_load(attributes[SOFT_PLANE_U]),
+                         f4_load(attributes[SOFT_PLANE_U + 1]), mask, samples);
+            for (int k = 0; k < 4; k++)
+                f4_store(texels[k], samples[k]);
+
+            // fragments by channel then lane, blended together
+            float fragments[4][4] = {{0}};
+
+            for (int lane = 0; lane < 4; lane++) {
+                if ((mask & (1 << lane)) == 0)
+                    continue;
+
+                float const uv[2] = {attributes[SOFT_PLANE_U][lane],
+                                     attributes[SOFT_PLANE_U + 1][lane]};
+                Vector4 const texel = {texels[0][lane], texels[1][lane],
+                                       texels[2][lane], texels[3][lane]};
+                float const color[4] = {attributes[SOFT_PLANE_COLOR][lane],
+                                        attributes[SOFT_PLANE_COLOR + 1][lane],
+                                        attributes[SOFT_PLANE_COLOR + 2][lane],
+                                        attributes[SOFT_PLANE_COLOR + 3][lane]};
+                Vector4 fragment;
+
+                if (!soft_shade(target, triangle, uv, texel, color,
+                                attributes[SOFT_PLANE_INV_W][lane],
+                                x + lane + 0.5f, py, &fragment)) {
+                    mask &= ~(1 << lane);
+                    continue;
+                }
+
+                fragments[0][lane] = fragment.x;
+                fragments[1][lane] = fragment.y;
+                fragments[2][lane] = fragment.z;
+                fragments[3][lane] = fragment.w;
+            }
+
+            if (mask == 0)
+                continue;
+
+            f4_t const src[4] = {f4_load(fragments[0]), f4_load(fragments[1]),
+                                 f4_load(fragments[2]), f4_load(fragments[3])};
+            soft_blend4(&target->color[offset], src, mask);
+
+            for (int lane = 0; lane < 4 && depth_test; lane++)
+                if (mask & (1 << lane))
+                    target->depth[offset + lane] =
+                        attributes[SOFT_PLANE_DEPTH][lane];
+        }
+    }
+}
+
+// pixel stage, the triangles of a tile in draw order
+void soft_tile_job(void* arg) {
+    soft_tile_job_t* const job = arg;
+    soft_target_t* const target = job->target;
+    soft_bin_t const* const bin = &target->bins[job->tile];
+
+    int const tile_x0 = (job->tile % target->tiles_x) * SOFT_TILE_SIZE;
+    int const tile_y0 = (job->tile / target->tiles_x) * SOFT_TILE_SIZE;
+    int const tile_x1 = MIN(tile_x0 + SOFT_TILE_SIZE, target->width) - 1;
+    int const tile_y1 = MIN(tile_y0 + SOFT_TILE_SIZE, target->height) - 1;
+
+    for (int i = 0; i < bin->count; i++)
+        soft_rasterize(target, &target->triangles[bin->triangles[i]], tile_x0,
+                       tile_y0, tile_x1, tile_y1);
+}
+
+void soft_bin_push(soft_bin_t* bin, int triangle) {
+    if (bin->count == bin->capacity) {
+        bin->capacity = bin->capacity > 0 ? bin->capacity * 2 : 256;
+        bin->triangles =
+            realloc(bin->triangles, sizeof(int) * bin->capacity);
+    }
+
+    bin->triangles[bin->count++] = triangle;
+}
+
+// runs fn over the batches of count items and waits for them
+void soft_run_batches(soft_target_t* target, soft_batch_job_t* jobs,
+                      int batch_count, job_fn_t fn) {
+    job_group_t group = {0};
+
+    for (int i = 0; i < batch_count; i++)
+        jobs_push(&target->jobs, fn, &jobs[i], &group);
+
+    jobs_wait(&target->jobs, &group);
+}
+
+void soft_draw_mesh(soft_target_t* target, Mesh const* mesh, Matrix mvp,
+                    soft_material_t const* material) {
+    PROFILE_ZONE("soft_draw_mesh");
+
+    int const vertex_count = mesh->vertexCount;
+    int const triangle_count = mesh->triangleCount;
+
+    if (vertex_count <= 0 || triangle_count <= 0 || mesh->vertices == NULL)
+        return;
+
+    target->material = *material;
+    target->texture_width =
+        material->texture != NULL ? material->texture->width : 1;
+    target->texture_height =
+        material->texture != NULL ? material->texture->height : 1;
+
+    if (target->clip_capacity < vertex_count) {
+        target->clip_capacity = vertex_count;
+        target->clip = realloc(target->clip, sizeof(Vector4) * vertex_count);
+    }
+
+    // a triangle clipped by the near plane becomes 2 at most
+    if (target->triangle_capacity < triangle_count * 2) {
+        target->triangle_capacity = triangle_count * 2;
+        target->triangles = realloc(target->triangles, sizeof(soft_triangle_t) *
+                                                           triangle_count * 2);
+    }
+
+    int const vertex_batches = (vertex_count + SOFT_BATCH_SIZE - 1) /
+                               SOFT_BATCH_SIZE;
+    int const triangle_batches = (triangle_count + SOFT_BATCH_SIZE - 1) /
+                                 SOFT_BATCH_SIZE;
+    soft_batch_job_t* const batches = malloc(
+        sizeof(soft_batch_job_t) * MAX(vertex_batches, triangle_batches));
+
+    for (int i = 0; i < vertex_batches; i++)
+        batches[i] = (soft_batch_job_t){
+            .target = target,
+            .mesh = mesh,
+            .mvp = mvp,
+            .first = i * SOFT_BATCH_SIZE,
+            .count = MIN(SOFT_BATCH_SIZE, vertex_count - i * SOFT_BATCH_SIZE)};
+    soft_run_batches(target, batches, vertex_batches, soft_transform_job);
+
+    for (int i = 0; i < triangle_batches; i++) {
+        int const first = i * SOFT_BATCH_SIZE;
+        batches[i] = (soft_batch_job_t){
+            .target = target,
+            .mesh = mesh,
+            .first = first,
+            .count = MIN(SOFT_BATCH_SIZE, triangle_count - first),
+            .out = &target->triangles[first * 2]};
+    }
+    soft_run_batches(target, batches, triangle_batches, soft_setup_job);
+
+    // binning in batch order keeps every tile in draw order
+    int const tile_count = target->tiles_x * target->tiles_y;
+    for (int i = 0; i < tile_count; i++)
+        target->bins[i].count = 0;
+
+    for (int i = 0; i < triangle_batches; i++) {
+        for (int j = 0; j < batches[i].out_count; j++) {
+            soft_triangle_t const* const triangle = &batches[i].out[j];
+            int const index = (int)(triangle - target->triangles);
+
+            for (int ty = triangle->min_y / SOFT_TILE_SIZE;
+                 ty <= triangle->max_y / SOFT_TILE_SIZE; ty++)
+                for (int tx = triangle->min_x / SOFT_TILE_SIZE;
+                     tx <= triangle->max_x / SOFT_TILE_SIZE; tx++)
+                    soft_bin_push(&target->bins[ty * target->tiles_x + tx],
+                                  index);
+        }
+
+        target->drawn_triangles += batches[i].out_count;
+    }
+
+    free(batches);
+
+    soft_tile_job_t* const tiles = malloc(sizeof(soft_tile_job_t) * tile_count);
+    job_group_t group = {0};
+
+    for (int i = 0; i < tile_count; i++) {
+        if (target->bins[i].count == 0)
+            continue;
+
+        tiles[i] = (soft_tile_job_t){.target = target, .tile = i};
+        jobs_push(&target->jobs, soft_tile_job, &tiles[i], &group);
+    }
+
+    jobs_wait(&target->jobs, &group);
+    free(tiles);
+}
@@ -0,0 +1,136 @@
+#ifndef SOURCE_SOFTRASTER_C
+#define SOURCE_SOFTRASTER_C
+
+#include "Base.h"
+#include "RayLib.h"
+#include "Jobs.h"
+
+// side of the screen tiles rasterized by the workers
+#define SOFT_TILE_SIZE ((int)64)
+// vertices transformed, or triangles set up, by a single job
+#define SOFT_BATCH_SIZE ((int)4096)
+// distance field change per atlas texel, as raylib bakes the
+// sdf glyphs (a pixel distance scale of 64 over 255)
+#define SOFT_SDF_DISTANCE_PER_TEXEL ((float)(64.0 / 255.0))
+
+// interpolated per pixel: depth, 1/w, then texcoords
+// and vertex color, both divided by w
+#define SOFT_PLANE_DEPTH ((int)0)
+#define SOFT_PLANE_INV_W ((int)1)
+#define SOFT_PLANE_U ((int)2)
+#define SOFT_PLANE_COLOR ((int)4)
+#define SOFT_PLANE_COUNT ((int)8)
+
+// an rgba8 copy of an image, sampled bilinearly with repeat wrapping
+typedef struct {
+    int width;
+    int height;
+    Color* pixels;
+} soft_texture_t;
+
+// what the gpu shaders of the demo compute, per fragment
+typedef enum {
+    // texel * tint * vertex color (raylib's default shader)
+    SOFT_SHADER_DEFAULT,
+    // Wireframe.fs, the vertex colors hold the corner barycentrics
+    SOFT_SHADER_CROSSFADE,
+    // Ui.fs, shapes have negative texcoords and glyphs
+    // are cut from a distance field atlas
+    SOFT_SHADER_UI
+} soft_shader_t;
+
+typedef struct {
+    soft_shader_t shader;
+    // null samples white
+    soft_texture_t const* texture;
+    Color tint;
+    // crossfade only
+    Color wire_color;
+    float wire_width;
+    // tested and written, as in raylib's 3d mode
+    bool depth_test;
+    // back faces (clockwise on screen) are skipped, as rlgl does
+    bool cull_back_faces;
+} soft_material_t;
+
+// a triangle set up for rasterization, in pixels
+typedef struct {
+    // e(x, y) = a * x + b * y + c, positive inside
+    float edges[3][3];
+    // pixels exactly on a top or left edge belong to the triangle,
+    // so that shared edges are drawn (and blended) once
+    bool top_left[3];
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    // value(x, y) = dx * x + dy * y + base, see SOFT_PLANE_*
+    float planes[SOFT_PLANE_COUNT][3];
+    // atlas texels covered by a pixel, for the distance field width
+    float texel_footprint;
+} soft_triangle_t;
+
+// the triangles overlapping a tile, in draw order
+typedef struct {
+    int* triangles;
+    int count;
+    int capacity;
+} soft_bin_t;
+
+// an in-memory framebuffer and the state of the draw in flight.
+// each draw transforms and sets up its triangles in batches, bins
+// them into tiles and rasterizes every tile on its own worker, the
+// triangles of a tile staying in order so that blending (and the
+// result) is deterministic
+typedef struct {
+    int width;
+    int height;
+    // row length of the buffers, padded to whole 4 pixel groups
+    int stride;
+    Color* color;
+    float* depth;
+
+    int tiles_x;
+    int tiles_y;
+    soft_bin_t* bins;
+
+    // scratch of the draw in flight
+    Vector4* clip;
+    int clip_capacity;
+    soft_triangle_t* triangles;
+    int triangle_capacity;
+    soft_material_t material;
+    float texture_width;
+    float texture_height;
+
+    jobs_t jobs;
+    // triangles rasterized since the last soft_clear
+    int64_t drawn_triangles;
+} soft_target_t;
+
+soft_texture_t load_soft_texture(Image image);
+void unload_soft_texture(soft_texture_t texture);
+
+// worker_count <= 0 means one per hardware thread
+void init_soft_target(soft_target_t* target, int width, int height,
+                      int worker_count);
+void deinit_soft_target(soft_target_t* target);
+
+// clears the color and resets the depth to the far plane
+void soft_clear(soft_target_t* target, Color color);
+
+// draws the mesh's triangles (cpu copies) transformed by mvp,
+// blending as raylib's default alpha mode
+void soft_draw_mesh(soft_target_t* target, Mesh const* mesh, Matrix mvp,
+                    soft_material_t const* material);
+
+// the model-view-projection of BeginMode3D(camera) with the transform
+Matrix soft_camera_mvp(Camera3D camera, Matrix transform, int width,
+                       int height);
+// the projection of the 2d mode, pixels with y down
+Matrix soft_screen_mvp(int width, int height);
+
+// an rgba8 copy of the framebuffer
+Image soft_target_image(soft_target_t const* target);
+
+#endif
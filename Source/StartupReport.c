@@ -0,0 +1,105 @@
+#include "StartupReport.h"
+#include "RayLib.h"
+#include "Profiler.h"
+#include <pthread.h>
+#include <string.h>
+
+typedef struct {
+    startup_entry_t entries[STARTUP_REPORT_CAPACITY];
+    int count;
+    bool recording;
+    double start;
+    pthread_mutex_t mutex;
+} startup_report_t;
+
+startup_report_t startup_report = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+void startup_report_begin() {
+    pthread_mutex_lock(&startup_report.mutex);
+    startup_report.count = 0;
+    startup_report.recording = true;
+    startup_report.start = profiler_time();
+    pthread_mutex_unlock(&startup_report.mutex);
+}
+
+void startup_report_add(char const* kind, char const* asset, double start,
+                        int64_t bytes) {
+    double const end = profiler_time();
+    pthread_mutex_lock(&startup_report.mutex);
+
+    if (startup_report.recording &&
+        startup_report.count < STARTUP_REPORT_CAPACITY)
+        startup_report.entries[startup_report.count++] = (startup_entry_t){
+            .kind = kind,
+            .asset = asset,
+            .start = start - startup_report.start,
+            .duration = end - start,
+            .bytes = bytes};
+
+    pthread_mutex_unlock(&startup_report.mutex);
+}
+
+int64_t startup_asset_bytes(char const* path) {
+    return FileExists(path) ? (int64_t)GetFileLength(path) : 0;
+}
+
+// logs the time and bytes summed by kind, in order of appearance
+void startup_report_log_totals() {
+    for (int i = 0; i < startup_report.count; i++) {
+        char const* const kind = startup_report.entries[i].kind;
+
+        // already summed with a previous entry
+        bool is_first = true;
+        for (int j = 0; j < i && is_first; j++)
+            is_first = strcmp(startup_report.entries[j].kind, kind) != 0;
+
+        if (!is_first)
+            continue;
+
+        double duration = 0;
+        int64_t bytes = 0;
+        for (int j = i; j < startup_report.count; j++) {
+            if (strcmp(startup_report.entries[j].kind, kind) != 0)
+                continue;
+
+            duration += startup_report.entries[j].duration;
+            bytes += startup_report.entries[j].bytes;
+        }
+
+        TraceLog(LOG_INFO, "STARTUP: %-10s %9.2f ms %9.2f MB", kind,
+                 duration * 1000, bytes / (1024.0 * 1024.0));
+    }
+}
+
+bool startup_report_finish(char const* path) {
+    pthread_mutex_lock(&startup_report.mutex);
+
+    // never began (e.g. benchmark runs)
+    if (!startup_report.recording) {
+        pthread_mutex_unlock(&startup_report.mutex);
+        return false;
+    }
+
+    startup_report.recording = false;
+    double const total = profiler_time() - startup_report.start;
+    pthread_mutex_unlock(&startup_report.mutex);
+
+    startup_report_log_totals();
+    TraceLog(LOG_INFO, "STARTUP: total      %9.2f ms", total * 1000);
+
+    FILE* const file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+
+    fprintf(file, "kind,asset,start_ms,duration_ms,bytes\n");
+    for (int i = 0; i < startup_report.count; i++) {
+        startup_entry_t const e = startup_report.entries[i];
+        fprintf(file, "%s,%s,%.3f,%.3f,%lld\n", e.kind,
+                e.asset != NULL ? e.asset : "", e.start * 1000,
+                e.duration * 1000, (long long)e.bytes);
+    }
+    fprintf(file, "total,,0.000,%.3f,0\n", total * 1000);
+
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef SOURCE_STARTUPREPORT_C
+#define SOURCE_STARTUPREPORT_C
+
+#include "Base.h"
+
+#define STARTUP_REPORT_PATH ((char const*)"startup_report.csv")
+#define STARTUP_REPORT_CAPACITY ((int)1024)
+
+// one timed startup step, usually the load of an asset
+typedef struct {
+    // what was done (window, font, font_cache, mesh_cache, obj, lods,
+    // bvh, texture_cache, image, upload)
+    char const* kind;
+    // asset path, or null for steps without one
+    char const* asset;
+    // seconds since startup_report_begin
+    double start;
+    double duration;
+    // bytes read from disk, 0 when nothing was read
+    int64_t bytes;
+} startup_entry_t;
+
+// starts recording, entries are relative to this call
+void startup_report_begin();
+
+// records a step that started at start (profiler_time) and ends now.
+// thread-safe, ignored when not recording
+void startup_report_add(char const* kind, char const* asset, double start,
+                        int64_t bytes);
+
+// bytes read when loading the asset at path
+int64_t startup_asset_bytes(char const* path);
+
+// stops recording, writes the report as csv and logs the totals per kind.
+// false when not recording or the report can't be written
+bool startup_report_finish(char const* path);
+
+#endif
@@ -0,0 +1,199 @@
+#include "Streaming.h"
+#include "TextureStreaming.h"
+#include "MeshCache.h"
+
+// distance from the selected weapon in ctx_switch_weapon order
+int ctx_weapon_distance(ctx_t* ctx, int weapon_index) {
+    return abs((int)weapon_index - (int)ctx->selected_weapon);
+}
+
+bool ctx_is_weapon_wanted(ctx_t* ctx, int weapon_index) {
+    return !ctx->weapon_streaming ||
+           ctx_weapon_distance(ctx, weapon_index) <=
+               ctx->weapon_streaming_neighbours;
+}
+
+bool ctx_is_weapon_resident(ctx_t* ctx, int weapon_index) {
+    return ctx->weapons.residencies[weapon_index] == WEAPON_RESIDENT;
+}
+
+size_t ctx_weapon_memory_size(ctx_t* ctx, int weapon_index) {
+    return model_memory_size(ctx->weapons.models[weapon_index]) +
+           model_bvh_memory_size(&ctx->weapons.bvhs[weapon_index]);
+}
+
+// queues the cpu-side decoding of a weapon
+void ctx_request_weapon(ctx_t* ctx, int weapon_index) {
+    weapons_t* const weapons = &ctx->weapons;
+
+    if (weapons->residencies[weapon_index] != WEAPON_UNLOADED)
+        return;
+
+    weapons->loads[weapon_index].desc = &weapons->descs[weapon_index];
+    weapons->loads[weapon_index].texture_max_size =
+        ctx_texture_streaming_initial_size(ctx);
+    weapons->loads[weapon_index].is_cpu_only = ctx->is_cpu_only;
+    weapons->load_groups[weapon_index] = (job_group_t){0};
+    weapon_load_push(&ctx->jobs, &weapons->load_groups[weapon_index],
+                     &weapons->loads[weapon_index]);
+
+    weapons->residencies[weapon_index] = WEAPON_LOADING;
+}
+
+// uploads a weapon whose decoding is done
+void ctx_finish_weapon(ctx_t* ctx, int weapon_index) {
+    weapons_t* const weapons = &ctx->weapons;
+    weapon_load_t* const load = &weapons->loads[weapon_index];
+
+    weapons->models[weapon_index] = ctx->is_cpu_only
+                                        ? weapon_load_finish_cpu(load)
+                                        : weapon_load_finish(load);
+    weapons->lods[weapon_index] = load->lods;
+    weapons->bvhs[weapon_index] = load->bvh;
+    weapons->sizes[weapon_index] = ctx_weapon_memory_size(ctx, weapon_index);
+    weapons->residencies[weapon_index] = WEAPON_RESIDENT;
+
+    if (!ctx->is_cpu_only)
+        ctx_start_weapon_texture_streams(ctx, weapon_index);
+
+    TraceLog(LOG_INFO, "STREAMING: [%s] Resident (%.1f MB)",
+             weapons->names[weapon_index],
+             weapons->sizes[weapon_index] / (1024.0 * 1024.0));
+}
+
+// makes the weapon resident, blocking on its decoding
+void ctx_wait_weapon(ctx_t* ctx, int weapon_index) {
+    ctx_request_weapon(ctx, weapon_index);
+
+    if (ctx->weapons.residencies[weapon_index] != WEAPON_LOADING)
+        return;
+
+    jobs_wait(&ctx->jobs, &ctx->weapons.load_groups[weapon_index]);
+    ctx_finish_weapon(ctx, weapon_index);
+}
+
+// the resident data of a weapon, cpu side only for a cpu only ctx
+void ctx_unload_weapon(ctx_t* ctx, int weapon_index) {
+    unload_model_bvh(&ctx->weapons.bvhs[weapon_index]);
+
+    if (ctx->is_cpu_only) {
+        unload_model_lods_cpu(&ctx->weapons.lods[weapon_index]);
+        unload_model_cpu(ctx->weapons.models[weapon_index]);
+        return;
+    }
+
+    ctx_stop_weapon_texture_streams(ctx, weapon_index);
+    unload_model_lods(&ctx->weapons.lods[weapon_index]);
+    UnloadModel(ctx->weapons.models[weapon_index]);
+}
+
+void ctx_evict_weapon(ctx_t* ctx, int weapon_index) {
+    ctx_unload_weapon(ctx, weapon_index);
+    ctx->weapons.residencies[weapon_index] = WEAPON_UNLOADED;
+
+    TraceLog(LOG_INFO, "STREAMING: [%s] Evicted",
+             ctx->weapons.names[weapon_index]);
+}
+
+size_t ctx_resident_weapons_size(ctx_t* ctx) {
+    size_t size = 0;
+
+    for (int i = 0; i < ctx->weapons.count; i++)
+        if (ctx_is_weapon_resident(ctx, i))
+            size += ctx->weapons.sizes[i];
+
+    return size;
+}
+
+// evicts the resident weapon farthest from the selection,
+// out of the neighbourhood. returns false when none can be evicted
+bool ctx_evict_farthest_weapon(ctx_t* ctx) {
+    int farthest = -1;
+
+    for (int i = 0; i < ctx->weapons.count; i++) {
+        if (!ctx_is_weapon_resident(ctx, i) || ctx_is_weapon_wanted(ctx, i))
+            continue;
+
+        if (farthest < 0 || ctx_weapon_distance(ctx, i) >
+                                ctx_weapon_distance(ctx, farthest))
+            farthest = i;
+    }
+
+    if (farthest < 0)
+        return false;
+
+    ctx_evict_weapon(ctx, farthest);
+    return true;
+}
+
+void ctx_update_weapon_streaming(ctx_t* ctx) {
+    if (!ctx->weapon_streaming)
+        return;
+
+    // uploading what the workers decoded in the meantime
+    for (int i = 0; i < ctx->weapons.count; i++) {
+        if (ctx->weapons.residencies[i] == WEAPON_LOADING &&
+            jobs_is_done(&ctx->jobs, &ctx->weapons.load_groups[i]))
+            ctx_finish_weapon(ctx, i);
+    }
+
+    // prefetching the neighbours while under budget, so that
+    // the next switch finds its weapon already resident
+    ctx_request_weapon(ctx, ctx->selected_weapon);
+
+    for (int i = 0; i < ctx->weapons.count; i++)
+        if (ctx_is_weapon_wanted(ctx, i) &&
+            ctx_resident_weapons_size(ctx) < ctx->weapon_streaming_budget)
+            ctx_request_weapon(ctx, i);
+
+    // weapons out of the neighbourhood are only
+    // kept around while they fit in the budget
+    while (ctx_resident_weapons_size(ctx) > ctx->weapon_streaming_budget)
+        if (!ctx_evict_farthest_weapon(ctx))
+            break;
+}
+
+void init_ctx_weapons_streaming(ctx_t* ctx) {
+    for (int i = 0; i < ctx->weapons.count; i++)
+        ctx->weapons.residencies[i] = WEAPON_UNLOADED;
+
+    if (!ctx->weapon_streaming) {
+        load_weapons(&ctx->jobs, ctx->weapons.descs, ctx->weapons.count,
+                     ctx_texture_streaming_initial_size(ctx),
+                     ctx->is_cpu_only, ctx->weapons.loads, ctx->weapons.models,
+                     ctx->weapons.lods, ctx->weapons.bvhs);
+
+        for (int i = 0; i < ctx->weapons.count; i++) {
+            ctx->weapons.sizes[i] = ctx_weapon_memory_size(ctx, i);
+            ctx->weapons.residencies[i] = WEAPON_RESIDENT;
+
+            if (!ctx->is_cpu_only)
+                ctx_start_weapon_texture_streams(ctx, i);
+        }
+
+        return;
+    }
+
+    ctx_wait_weapon(ctx, ctx->selected_weapon);
+    ctx_update_weapon_streaming(ctx);
+}
+
+void deinit_ctx_weapons_streaming(ctx_t* ctx) {
+    for (int i = 0; i < ctx->weapons.count; i++) {
+        switch (ctx->weapons.residencies[i]) {
+            case WEAPON_LOADING:
+                jobs_wait(&ctx->jobs, &ctx->weapons.load_groups[i]);
+                weapon_load_discard(&ctx->weapons.loads[i]);
+                break;
+
+            case WEAPON_RESIDENT:
+                ctx_unload_weapon(ctx, i);
+                break;
+
+            default:
+                break;
+        }
+
+        ctx->weapons.residencies[i] = WEAPON_UNLOADED;
+    }
+}
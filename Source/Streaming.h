@@ -0,0 +1,24 @@
+#ifndef SOURCE_STREAMING_C
+#define SOURCE_STREAMING_C
+
+#include "Context.h"
+
+// loads the selected weapon synchronously and queues its
+// neighbours, or loads every weapon when streaming is off
+void init_ctx_weapons_streaming(ctx_t* ctx);
+
+// unloads every resident weapon, waiting for the in-flight ones
+void deinit_ctx_weapons_streaming(ctx_t* ctx);
+
+// finishes the loads done by the workers, prefetches the
+// neighbours of the selected weapon and evicts under the budget.
+// to call once per frame, after the selection changed
+void ctx_update_weapon_streaming(ctx_t* ctx);
+
+bool ctx_is_weapon_resident(ctx_t* ctx, int weapon_index);
+
+// estimated bytes a resident weapon takes (ctx_t.weapons.sizes):
+// its model, textures and bvh
+size_t ctx_weapon_memory_size(ctx_t* ctx, int weapon_index);
+
+#endif
@@ -0,0 +1,127 @@
+#include "TextCache.h"
+#include <string.h>
+
+#define TEXT_LAYOUT_MAX_VERTICES ((int)(TEXT_LAYOUT_MAX_LENGTH * 6))
+
+void init_text_cache(text_cache_t* cache) {
+    cache->frame = 0;
+
+    // arrays of the max size, so that a rebuild doesn't allocate
+    for (int i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+        text_layout_t* const layout = &cache->layouts[i];
+        *layout = (text_layout_t){0};
+        layout->positions = calloc(TEXT_LAYOUT_MAX_VERTICES, sizeof(Vector2));
+        layout->texcoords = calloc(TEXT_LAYOUT_MAX_VERTICES, sizeof(Vector2));
+    }
+}
+
+void deinit_text_cache(text_cache_t* cache) {
+    for (int i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+        free(cache->layouts[i].positions);
+        free(cache->layouts[i].texcoords);
+    }
+}
+
+bool text_layout_matches(text_layout_t const* layout, Font font,
+                         char const* text, float size, float spacing) {
+    return layout->font_texture == font.texture.id && layout->size == size &&
+           layout->spacing == spacing &&
+           strncmp(layout->text, text, TEXT_LAYOUT_MAX_LENGTH - 1) == 0;
+}
+
+// the glyph quads of DrawTextEx, written into the layout's arrays
+void text_layout_build(text_layout_t* layout, Font font) {
+    float const scale = layout->size / font.baseSize;
+    float const padding = font.glyphPadding;
+    Vector2 const atlas = vec2(font.texture.width, font.texture.height);
+
+    Vector2 offset = vec2(0, 0);
+    int vertex_count = 0;
+
+    for (int i = 0; layout->text[i] != '\0';) {
+        int codepoint_size = 0;
+        int const codepoint = GetCodepointNext(&layout->text[i], &codepoint_size);
+        int const glyph = GetGlyphIndex(font, codepoint);
+        i += codepoint_size;
+
+        if (codepoint == '\n') {
+            offset = vec2(0, offset.y + (int)((font.baseSize +
+                                               font.baseSize / 2.0f) *
+                                              scale));
+            continue;
+        }
+
+        Rectangle const source = font.recs[glyph];
+
+        if (codepoint != ' ' && codepoint != '\t') {
+            Rectangle const src = {source.x - padding, source.y - padding,
+                                   source.width + 2 * padding,
+                                   source.height + 2 * padding};
+            Rectangle const dst = {
+                offset.x + (font.glyphs[glyph].offsetX - padding) * scale,
+                offset.y + (font.glyphs[glyph].offsetY - padding) * scale,
+                src.width * scale, src.height * scale};
+
+            // top left, bottom left, bottom right, top right
+            Vector2 const corners[4] = {vec2(0, 0), vec2(0, 1), vec2(1, 1),
+                                        vec2(1, 0)};
+            int const triangles[6] = {0, 1, 2, 0, 2, 3};
+
+            for (int k = 0; k < 6; k++) {
+                Vector2 const c = corners[triangles[k]];
+                layout->positions[vertex_count] =
+                    vec2(dst.x + dst.width * c.x, dst.y + dst.height * c.y);
+                layout->texcoords[vertex_count] =
+                    vec2((src.x + src.width * c.x) / atlas.x,
+                         (src.y + src.height * c.y) / atlas.y);
+                vertex_count++;
+            }
+        }
+
+        offset.x += (font.glyphs[glyph].advanceX == 0
+                         ? source.width
+                         : font.glyphs[glyph].advanceX) *
+                        scale +
+                    layout->spacing;
+    }
+
+    layout->vertex_count = vertex_count;
+}
+
+text_layout_t const* text_cache_layout(text_cache_t* cache, Font font,
+                                       char const* text, float size,
+                                       float spacing) {
+    text_layout_t* oldest = &cache->layouts[0];
+
+    for (int i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+        text_layout_t* const layout = &cache->layouts[i];
+
+        if (text_layout_matches(layout, font, text, size, spacing)) {
+            layout->last_used = cache->frame;
+            return layout;
+        }
+
+        if (layout->last_used < oldest->last_used)
+            oldest = layout;
+    }
+
+    // miss, rebuilding the least recently used layout
+    oldest->font_texture = font.texture.id;
+    oldest->size = size;
+    oldest->spacing = spacing;
+    snprintf(oldest->text, sizeof(oldest->text), "%s", text);
+    oldest->extents = MeasureTextEx(font, oldest->text, size, spacing);
+    oldest->last_used = cache->frame;
+    text_layout_build(oldest, font);
+
+    return oldest;
+}
+
+Vector2 text_cache_measure(text_cache_t* cache, Font font, char const* text,
+                           float size, float spacing) {
+    return text_cache_layout(cache, font, text, size, spacing)->extents;
+}
+
+void text_cache_next_frame(text_cache_t* cache) {
+    cache->frame++;
+}
@@ -0,0 +1,54 @@
+#ifndef SOURCE_TEXTCACHE_C
+#define SOURCE_TEXTCACHE_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+// layouts kept, the least recently drawn one is rebuilt on a miss
+#define TEXT_CACHE_CAPACITY ((int)32)
+// bytes of a cached string, longer ones are cut
+#define TEXT_LAYOUT_MAX_LENGTH ((int)64)
+
+// a string laid out once: its extents and its glyph quads,
+// cpu side only (the hud batches them into its own buffer)
+typedef struct {
+    // key
+    unsigned int font_texture;
+    float size;
+    float spacing;
+    char text[TEXT_LAYOUT_MAX_LENGTH];
+
+    // what MeasureTextEx would return
+    Vector2 extents;
+    // 2 triangles per visible glyph, relative to the text's origin.
+    // the arrays are sized for TEXT_LAYOUT_MAX_LENGTH glyphs,
+    // vertex_count is the part in use
+    Vector2* positions;
+    Vector2* texcoords;
+    int vertex_count;
+    // text_cache_t.frame of the last use
+    uint64_t last_used;
+} text_layout_t;
+
+typedef struct {
+    text_layout_t layouts[TEXT_CACHE_CAPACITY];
+    // advanced by text_cache_next_frame
+    uint64_t frame;
+} text_cache_t;
+
+void init_text_cache(text_cache_t* cache);
+void deinit_text_cache(text_cache_t* cache);
+
+// the layout of the text, built only on a miss
+text_layout_t const* text_cache_layout(text_cache_t* cache, Font font,
+                                       char const* text, float size,
+                                       float spacing);
+
+// MeasureTextEx through the cache
+Vector2 text_cache_measure(text_cache_t* cache, Font font, char const* text,
+                           float size, float spacing);
+
+// marks the start of a frame, for the least recently drawn eviction
+void text_cache_next_frame(text_cache_t* cache);
+
+#endif
@@ -0,0 +1,549 @@
+#include "TextureCache.h"
+#include "MeshCache.h"
+#include "Profiler.h"
+#include <string.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// loaded by raylib with the rest of gl, rlgl has
+// no wrapper to bound the levels of a texture
+#define GL_TEXTURE_2D ((unsigned int)0x0DE1)
+#define GL_TEXTURE_MAX_LEVEL ((unsigned int)0x813D)
+extern void (*glad_glTexParameteri)(unsigned int target, unsigned int name,
+                                    int param);
+
+void texture_cache_path(char const* image_path, char* buf, int buf_size) {
+    char const* ext = strrchr(image_path, '.');
+    int const stem_length = ext != NULL ? (int)(ext - image_path)
+                                        : (int)strlen(image_path);
+
+    snprintf(buf, buf_size, "%.*s%s", stem_length, image_path,
+             TEXTURE_CACHE_EXTENSION);
+}
+
+// bytes of the whole mip chain as raylib uploads it
+uint32_t image_chain_size(int width, int height, int mipmaps, int format) {
+    uint32_t size = 0;
+
+    for (int level = 0; level < mipmaps; level++) {
+        size += (uint32_t)GetPixelDataSize(width, height, format);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+
+    return size;
+}
+
+int texture_fitting_level(int width, int height, int mipmaps, int max_size) {
+    int level = 0;
+
+    while (max_size > 0 && level < mipmaps - 1 &&
+           (width > max_size || height > max_size)) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        level++;
+    }
+
+    return level;
+}
+
+bool texture_cache_read_header(FILE* file, char const* image_path,
+                               int64_t file_size,
+                               texture_cache_header_t* header) {
+    return fread(header, sizeof(*header), 1, file) == 1 &&
+           header->magic == TEXTURE_CACHE_MAGIC &&
+           header->version == TEXTURE_CACHE_VERSION &&
+           header->source_mod_time == (int64_t)GetFileModTime(image_path) &&
+           header->source_size == (int64_t)GetFileLength(image_path) &&
+           (header->format == PIXELFORMAT_COMPRESSED_DXT1_RGB ||
+            header->format == PIXELFORMAT_COMPRESSED_DXT5_RGBA) &&
+           header->width > 0 && header->height > 0 && header->mipmaps > 0 &&
+           (int64_t)header->data_size == file_size - (int64_t)sizeof(*header) &&
+           header->data_size == image_chain_size(header->width, header->height,
+                                                 header->mipmaps,
+                                                 header->format);
+}
+
+bool texture_cache_load(char const* image_path, int max_size, Image* image,
+                        texture_cache_header_t* header) {
+    PROFILE_ZONE("texture_cache_load");
+
+    if (!is_host_little_endian())
+        return false;
+
+    char cache_path[TEXTURE_CACHE_PATH_MAX_LENGTH];
+    texture_cache_path(image_path, cache_path, sizeof(cache_path));
+
+    FILE* const file = fopen(cache_path, "rb");
+    if (file == NULL)
+        return false;
+
+    texture_cache_header_t h;
+    bool ok = texture_cache_read_header(file, image_path,
+                                        GetFileLength(cache_path), &h);
+
+    if (ok) {
+        // the levels above the fitting one are skipped, not read
+        int const level =
+            texture_fitting_level(h.width, h.height, h.mipmaps, max_size);
+        uint32_t const skipped =
+            image_chain_size(h.width, h.height, level, h.format);
+        uint32_t const size = h.data_size - skipped;
+
+        *image = (Image){.data = RL_MALLOC(size),
+                         .width = MAX(h.width >> level, 1),
+                         .height = MAX(h.height >> level, 1),
+                         .mipmaps = h.mipmaps - level,
+                         .format = h.format};
+
+        ok = fseek(file, (long)(sizeof(h) + skipped), SEEK_SET) == 0 &&
+             fread(image->data, 1, size, file) == size;
+
+        if (!ok) {
+            UnloadImage(*image);
+            *image = (Image){0};
+        }
+    }
+
+    fclose(file);
+
+    if (!ok) {
+        TraceLog(LOG_WARNING, "TEXCACHE: [%s] Stale or malformed cache",
+                 cache_path);
+        return false;
+    }
+
+    if (header != NULL)
+        *header = h;
+
+    return true;
+}
+
+bool texture_cache_save(char const* image_path, Image image) {
+    if (!is_host_little_endian())
+        return false;
+
+    char cache_path[TEXTURE_CACHE_PATH_MAX_LENGTH];
+    texture_cache_path(image_path, cache_path, sizeof(cache_path));
+
+    uint32_t const data_size = image_chain_size(image.width, image.height,
+                                                image.mipmaps, image.format);
+    texture_cache_header_t const header = {
+        .magic = TEXTURE_CACHE_MAGIC,
+        .version = TEXTURE_CACHE_VERSION,
+        .source_mod_time = (int64_t)GetFileModTime(image_path),
+        .source_size = (int64_t)GetFileLength(image_path),
+        .width = image.width,
+        .height = image.height,
+        .format = image.format,
+        .mipmaps = image.mipmaps,
+        .data_size = data_size};
+
+    uint8_t* const blob = RL_MALLOC(sizeof(header) + data_size);
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), image.data, data_size);
+
+    bool const ok =
+        SaveFileData(cache_path, blob, (unsigned int)(sizeof(header) + data_size));
+    RL_FREE(blob);
+
+    return ok;
+}
+
+// the 16 pixels of a block, repeating the last
+// row and column past the edges of the level
+void fetch_block(Color const* pixels, int width, int height, int x, int y,
+                 Color block[16]) {
+    for (int j = 0; j < 4; j++) {
+        int const py = y + j < height ? y + j : height - 1;
+
+        for (int i = 0; i < 4; i++) {
+            int const px = x + i < width ? x + i : width - 1;
+            block[j * 4 + i] = pixels[py * width + px];
+        }
+    }
+}
+
+uint16_t color_to_565(Color c) {
+    return (uint16_t)(((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3));
+}
+
+Color color_from_565(uint16_t v) {
+    uint8_t const r = (v >> 11) & 31;
+    uint8_t const g = (v >> 5) & 63;
+    uint8_t const b = v & 31;
+
+    return color((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2),
+                 255);
+}
+
+void write_u16(uint8_t* out, uint16_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+}
+
+// bc1 color block: the endpoints are the bounding box of the block's
+// colors, inset to lower the error of the extremes, and every pixel
+// takes the palette entry nearest its projection on their line
+void encode_bc1_colors(Color const block[16], uint8_t* out) {
+    Color lo = block[0];
+    Color hi = block[0];
+
+    for (int i = 1; i < 16; i++) {
+        lo = color(MIN(lo.r, block[i].r), MIN(lo.g, block[i].g),
+                   MIN(lo.b, block[i].b), 255);
+        hi = color(MAX(hi.r, block[i].r), MAX(hi.g, block[i].g),
+                   MAX(hi.b, block[i].b), 255);
+    }
+
+    Color const inset = color((hi.r - lo.r) / 16, (hi.g - lo.g) / 16,
+                              (hi.b - lo.b) / 16, 0);
+    lo = color(lo.r + inset.r, lo.g + inset.g, lo.b + inset.b, 255);
+    hi = color(hi.r - inset.r, hi.g - inset.g, hi.b - inset.b, 255);
+
+    // c0 > c1 selects the opaque 4 colors palette
+    uint16_t c0 = color_to_565(hi);
+    uint16_t c1 = color_to_565(lo);
+    if (c0 < c1) {
+        uint16_t const swap = c0;
+        c0 = c1;
+        c1 = swap;
+    }
+
+    Color const e0 = color_from_565(c0);
+    Color const e1 = color_from_565(c1);
+    int const dir[3] = {e1.r - e0.r, e1.g - e0.g, e1.b - e0.b};
+    int const length2 = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+    uint32_t indices = 0;
+
+    // palette order is e0, e1, 2/3 e0 + 1/3 e1, 1/3 e0 + 2/3 e1
+    for (int i = 0; i < 16 && length2 > 0; i++) {
+        int const dot = (block[i].r - e0.r) * dir[0] +
+                        (block[i].g - e0.g) * dir[1] +
+                        (block[i].b - e0.b) * dir[2];
+        float const t = (float)dot / length2;
+        uint32_t const code = t < 1.0f / 6 ? 0
+                              : t < 3.0f / 6 ? 2
+                              : t < 5.0f / 6 ? 3
+                                             : 1;
+        indices |= code << (i * 2);
+    }
+
+    write_u16(out, c0);
+    write_u16(out + 2, c1);
+    write_u16(out + 4, (uint16_t)indices);
+    write_u16(out + 6, (uint16_t)(indices >> 16));
+}
+
+// bc3 alpha block, always in the 8 values mode (a0 > a1)
+void encode_bc3_alpha(Color const block[16], uint8_t* out) {
+    uint8_t a0 = block[0].a;
+    uint8_t a1 = block[0].a;
+
+    for (int i = 1; i < 16; i++) {
+        a0 = MAX(a0, block[i].a);
+        a1 = MIN(a1, block[i].a);
+    }
+
+    uint64_t bits = 0;
+
+    // palette order is a0, a1, then 6/7 a0 + 1/7 a1 ... 1/7 a0 + 6/7 a1
+    for (int i = 0; i < 16 && a0 > a1; i++) {
+        int const step = ((a0 - block[i].a) * 7 + (a0 - a1) / 2) / (a0 - a1);
+        uint64_t const code = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+        bits |= code << (i * 3);
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (uint8_t)(bits >> (i * 8));
+}
+
+bool is_image_opaque(Image image) {
+    Color const* const pixels = image.data;
+
+    for (int i = 0; i < image.width * image.height; i++)
+        if (pixels[i].a < 255)
+            return false;
+
+    return true;
+}
+
+Image compress_image(Image image) {
+    PROFILE_ZONE("compress_image");
+
+    Image rgba = ImageCopy(image);
+    ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    // the top level has to be made of whole blocks
+    if (rgba.width % 4 != 0 || rgba.height % 4 != 0)
+        ImageResize(&rgba, (rgba.width + 3) / 4 * 4,
+                    (rgba.height + 3) / 4 * 4);
+
+    bool const opaque = is_image_opaque(rgba);
+    int const format = opaque ? PIXELFORMAT_COMPRESSED_DXT1_RGB
+                              : PIXELFORMAT_COMPRESSED_DXT5_RGBA;
+    int const block_size = opaque ? BC1_BLOCK_SIZE : BC3_BLOCK_SIZE;
+
+    ImageMipmaps(&rgba);
+
+    // raylib sizes the levels as bits per pixel times pixels, which
+    // only counts whole blocks when the sides stay multiples of 4 (or
+    // both fall under it). the chain stops before the first level that
+    // doesn't, non-square textures lose only their smallest levels
+    int mipmaps = rgba.mipmaps;
+    for (int level = 0, w = rgba.width, h = rgba.height; level < rgba.mipmaps;
+         level++, w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1) {
+        int const blocks = ((w + 3) / 4) * ((h + 3) / 4);
+
+        if (blocks * block_size != GetPixelDataSize(w, h, format)) {
+            mipmaps = level > 0 ? level : 1;
+            break;
+        }
+    }
+
+    Image compressed = {.width = rgba.width,
+                        .height = rgba.height,
+                        .mipmaps = mipmaps,
+                        .format = format};
+    compressed.data = RL_MALLOC(
+        image_chain_size(rgba.width, rgba.height, mipmaps, format));
+
+    Color const* pixels = rgba.data;
+    uint8_t* out = compressed.data;
+
+    for (int level = 0, w = rgba.width, h = rgba.height; level < mipmaps;
+         level++, w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1) {
+        for (int y = 0; y < h; y += 4) {
+            for (int x = 0; x < w; x += 4) {
+                Color block[16];
+                fetch_block(pixels, w, h, x, y, block);
+
+                if (!opaque) {
+                    encode_bc3_alpha(block, out);
+                    out += BC3_BLOCK_SIZE - BC1_BLOCK_SIZE;
+                }
+
+                encode_bc1_colors(block, out);
+                out += BC1_BLOCK_SIZE;
+            }
+        }
+
+        pixels += w * h;
+    }
+
+    UnloadImage(rgba);
+    return compressed;
+}
+
+uint16_t read_u16(uint8_t const* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+// bc1 color block into the 16 pixels, the alpha left as it is. the
+// 3 colors palette (c0 <= c1) ends with black, opaque in bc1 rgb
+void decode_bc1_colors(uint8_t const* in, Color block[16]) {
+    uint16_t const c0 = read_u16(in);
+    uint16_t const c1 = read_u16(in + 2);
+    uint32_t const indices = read_u16(in + 4) | (uint32_t)read_u16(in + 6) << 16;
+    Color const e0 = color_from_565(c0);
+    Color const e1 = color_from_565(c1);
+    Color palette[4] = {e0, e1};
+
+    if (c0 > c1) {
+        palette[2] = color((2 * e0.r + e1.r) / 3, (2 * e0.g + e1.g) / 3,
+                           (2 * e0.b + e1.b) / 3, 255);
+        palette[3] = color((e0.r + 2 * e1.r) / 3, (e0.g + 2 * e1.g) / 3,
+                           (e0.b + 2 * e1.b) / 3, 255);
+    } else {
+        palette[2] = color((e0.r + e1.r) / 2, (e0.g + e1.g) / 2,
+                           (e0.b + e1.b) / 2, 255);
+        palette[3] = color(0, 0, 0, 255);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        Color const c = palette[(indices >> (i * 2)) & 3];
+        block[i] = color(c.r, c.g, c.b, block[i].a);
+    }
+}
+
+// bc3 alpha block into the alpha of the 16 pixels, in either mode
+void decode_bc3_alpha(uint8_t const* in, Color block[16]) {
+    int const a0 = in[0];
+    int const a1 = in[1];
+    uint64_t bits = 0;
+    uint8_t palette[8] = {(uint8_t)a0, (uint8_t)a1};
+
+    for (int i = 0; i < 6; i++)
+        bits |= (uint64_t)in[2 + i] << (i * 8);
+
+    if (a0 > a1) {
+        for (int i = 1; i < 7; i++)
+            palette[1 + i] = (uint8_t)(((7 - i) * a0 + i * a1) / 7);
+    } else {
+        for (int i = 1; i < 5; i++)
+            palette[1 + i] = (uint8_t)(((5 - i) * a0 + i * a1) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (int i = 0; i < 16; i++)
+        block[i].a = palette[(bits >> (i * 3)) & 7];
+}
+
+bool decode_bc_image(Image* image) {
+    int const format = image->format;
+
+    if (format != PIXELFORMAT_COMPRESSED_DXT1_RGB &&
+        format != PIXELFORMAT_COMPRESSED_DXT5_RGBA)
+        return image->data != NULL;
+
+    int const width = image->width;
+    int const height = image->height;
+    Color* const pixels = RL_MALLOC(sizeof(Color) * width * height);
+    uint8_t const* in = image->data;
+
+    for (int y = 0; y < height; y += 4) {
+        for (int x = 0; x < width; x += 4) {
+            Color block[16];
+
+            for (int i = 0; i < 16; i++)
+                block[i] = color(0, 0, 0, 255);
+
+            if (format == PIXELFORMAT_COMPRESSED_DXT5_RGBA) {
+                decode_bc3_alpha(in, block);
+                in += BC3_BLOCK_SIZE - BC1_BLOCK_SIZE;
+            }
+
+            decode_bc1_colors(in, block);
+            in += BC1_BLOCK_SIZE;
+
+            // levels under 4 pixels still take whole blocks
+            for (int j = 0; j < 4 && y + j < height; j++)
+                for (int i = 0; i < 4 && x + i < width; i++)
+                    pixels[(y + j) * width + x + i] = block[j * 4 + i];
+        }
+    }
+
+    UnloadImage(*image);
+    *image = (Image){.data = pixels,
+                     .width = width,
+                     .height = height,
+                     .mipmaps = 1,
+                     .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+
+    return true;
+}
+
+// decodes and compresses the source, then rewrites the cache
+Image bake_image(char const* image_path, bool* saved) {
+    Image const source = LoadImage(image_path);
+    *saved = false;
+
+    if (source.data == NULL)
+        return source;
+
+    Image const compressed = compress_image(source);
+    UnloadImage(source);
+
+    *saved = texture_cache_save(image_path, compressed);
+    if (*saved)
+        TraceLog(LOG_INFO, "TEXCACHE: [%s] Baked %dx%d, %d mips, %s",
+                 image_path, compressed.width, compressed.height,
+                 compressed.mipmaps,
+                 compressed.format == PIXELFORMAT_COMPRESSED_DXT1_RGB ? "bc1"
+                                                                      : "bc3");
+    else
+        TraceLog(LOG_WARNING, "TEXCACHE: [%s] Failed to bake", image_path);
+
+    return compressed;
+}
+
+// the levels of the image from level down, as an image of their own
+Image image_from_level(Image image, int level) {
+    uint32_t const skipped =
+        image_chain_size(image.width, image.height, level, image.format);
+    uint32_t const size =
+        image_chain_size(image.width, image.height, image.mipmaps,
+                         image.format) -
+        skipped;
+
+    Image const levels = {.data = RL_MALLOC(size),
+                          .width = MAX(image.width >> level, 1),
+                          .height = MAX(image.height >> level, 1),
+                          .mipmaps = image.mipmaps - level,
+                          .format = image.format};
+    memcpy(levels.data, (uint8_t const*)image.data + skipped, size);
+
+    return levels;
+}
+
+Image load_image_cached(char const* image_path, int max_size,
+                        bool* from_cache, texture_cache_header_t* header) {
+    Image image;
+    bool const cached =
+        texture_cache_load(image_path, max_size, &image, header);
+
+    if (from_cache != NULL)
+        *from_cache = cached;
+
+    if (cached)
+        return image;
+
+    // falling back to the source file, the compressed
+    // image is used right away even if it can't be saved
+    bool saved;
+    Image const baked = bake_image(image_path, &saved);
+
+    if (header != NULL)
+        *header = (texture_cache_header_t){0};
+
+    if (baked.data == NULL)
+        return baked;
+
+    // only a saved cache can stream the skipped levels in later
+    if (header != NULL && saved)
+        *header = (texture_cache_header_t){
+            .magic = TEXTURE_CACHE_MAGIC,
+            .version = TEXTURE_CACHE_VERSION,
+            .width = baked.width,
+            .height = baked.height,
+            .format = baked.format,
+            .mipmaps = baked.mipmaps,
+            .data_size = image_chain_size(baked.width, baked.height,
+                                          baked.mipmaps, baked.format)};
+
+    int const level = saved ? texture_fitting_level(baked.width, baked.height,
+                                                    baked.mipmaps, max_size)
+                            : 0;
+    if (level == 0)
+        return baked;
+
+    image = image_from_level(baked, level);
+    UnloadImage(baked);
+    return image;
+}
+
+Texture2D load_texture_levels(Image image) {
+    Texture2D const texture = LoadTextureFromImage(image);
+
+    // a truncated chain is incomplete for gl (sampling black)
+    // unless the missing levels are excluded
+    if (texture.id != 0 && image.mipmaps > 1) {
+        rlEnableTexture(texture.id);
+        glad_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                             image.mipmaps - 1);
+        rlDisableTexture();
+    }
+
+    return texture;
+}
+
+bool bake_texture(char const* image_path) {
+    bool saved;
+    UnloadImage(bake_image(image_path, &saved));
+
+    return saved;
+}
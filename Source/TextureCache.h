@@ -0,0 +1,79 @@
+#ifndef SOURCE_TEXTURECACHE_C
+#define SOURCE_TEXTURECACHE_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+#define TEXTURE_CACHE_MAGIC ((uint32_t)0x43544452) // "RDTC" little-endian
+#define TEXTURE_CACHE_VERSION ((uint32_t)2)
+#define TEXTURE_CACHE_EXTENSION ((char const*)".tcache")
+#define TEXTURE_CACHE_PATH_MAX_LENGTH ((int)256)
+
+// bytes of a 4x4 block
+#define BC1_BLOCK_SIZE ((int)8)
+#define BC3_BLOCK_SIZE ((int)16)
+
+// layout of the blob, every field is little-endian:
+//   texture_cache_header_t
+//   data_size bytes of blocks, every mip level one after the
+//   other from the largest (the layout of a raylib Image)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    // source image identity, a mismatch means the cache is stale
+    int64_t source_mod_time;
+    int64_t source_size;
+    int32_t width;
+    int32_t height;
+    // PIXELFORMAT_COMPRESSED_DXT1_RGB or PIXELFORMAT_COMPRESSED_DXT5_RGBA
+    int32_t format;
+    int32_t mipmaps;
+    uint32_t data_size;
+} texture_cache_header_t;
+
+// writes the cache path of an image (same name, cache extension) into buf
+void texture_cache_path(char const* image_path, char* buf, int buf_size);
+
+// first level of a mip chain whose sides fit max_size
+// (0 for the top level), the last level when none does
+int texture_fitting_level(int width, int height, int mipmaps, int max_size);
+
+// loads the compressed image from its cache, from the first level
+// fitting max_size (0 for the full chain) down, reading only those.
+// header (optional) receives the header of the full chain.
+// false when the cache is missing, stale or malformed.
+// cpu side only, safe to call from worker threads
+bool texture_cache_load(char const* image_path, int max_size, Image* image,
+                        texture_cache_header_t* header);
+
+// writes a compressed image into the cache of the source image
+bool texture_cache_save(char const* image_path, Image image);
+
+// generates the mip chain of the image and encodes every level
+// as bc1 (dxt1), or bc3 (dxt5) when some pixel isn't opaque.
+// the image is left untouched
+Image compress_image(Image image);
+
+// decodes the top level of a bc1 or bc3 image in place into rgba8,
+// dropping the other levels (for the cpu renderer, raylib only uploads
+// compressed formats). uncompressed images are left untouched.
+// false when the image has no data
+bool decode_bc_image(Image* image);
+
+// loads the image from the cache when fresh, otherwise decodes and
+// compresses the source and rebakes the cache. max_size and header
+// (optional) as in texture_cache_load, a zeroed header meaning the
+// cache couldn't be written (the full chain is returned then).
+// from_cache (optional) reports which path was taken.
+// safe to call from worker threads
+Image load_image_cached(char const* image_path, int max_size,
+                        bool* from_cache, texture_cache_header_t* header);
+
+// uploads a chain of the caches, which may stop before the 1x1 level
+// (gl thread only)
+Texture2D load_texture_levels(Image image);
+
+// decodes and compresses the source image, always rewriting the cache
+bool bake_texture(char const* image_path);
+
+#endif
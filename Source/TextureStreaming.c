@@ -0,0 +1,187 @@
+#include "TextureStreaming.h"
+#include "Streaming.h"
+
+// job argument to read the levels of a texture from its cache
+typedef struct {
+    char const* path;
+    int max_size;
+    Image* image;
+} texture_levels_job_t;
+
+void read_texture_levels_job(void* arg) {
+    PROFILE_ZONE("read_texture_levels_job");
+
+    texture_levels_job_t* const job = arg;
+    if (!texture_cache_load(job->path, job->max_size, job->image, NULL))
+        *job->image = (Image){0};
+
+    free(job);
+}
+
+int ctx_texture_streaming_initial_size(ctx_t* ctx) {
+    return ctx->texture_streaming ? ctx->texture_streaming_initial_size : 0;
+}
+
+bool is_texture_streamed(weapon_texture_stream_t const* stream) {
+    return stream->header.magic == TEXTURE_CACHE_MAGIC;
+}
+
+// side of a level, the chain halves it at each one
+int texture_level_size(texture_cache_header_t const* header, int level) {
+    int const side =
+        header->width > header->height ? header->width : header->height;
+    return side >> level > 0 ? side >> level : 1;
+}
+
+int texture_level_fitting(texture_cache_header_t const* header,
+                          int max_size) {
+    return texture_fitting_level(header->width, header->height,
+                                 header->mipmaps, max_size);
+}
+
+void ctx_start_weapon_texture_streams(ctx_t* ctx, int weapon_index) {
+    weapon_load_t const* const load = &ctx->weapons.loads[weapon_index];
+    Model const model = ctx->weapons.models[weapon_index];
+
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT; i++) {
+        weapon_texture_stream_t* const stream =
+            &ctx->weapons.texture_streams[weapon_index][i];
+        Texture2D const texture =
+            model.materials[0].maps[weapon_texture_material_map(i)].texture;
+
+        *stream = (weapon_texture_stream_t){.header = load->texture_headers[i],
+                                            .loading_level = -1};
+
+        if (!ctx->texture_streaming || texture.id == rlGetTextureIdDefault())
+            stream->header = (texture_cache_header_t){0};
+
+        if (is_texture_streamed(stream))
+            stream->resident_level = texture_level_fitting(
+                &stream->header, texture.width > texture.height
+                                     ? texture.width
+                                     : texture.height);
+    }
+}
+
+void ctx_stop_weapon_texture_streams(ctx_t* ctx, int weapon_index) {
+    for (int i = 0; i < WEAPON_TEXTURE_COUNT; i++) {
+        weapon_texture_stream_t* const stream =
+            &ctx->weapons.texture_streams[weapon_index][i];
+
+        if (stream->loading_level >= 0) {
+            jobs_wait(&ctx->jobs, &stream->group);
+            UnloadImage(stream->pending);
+        }
+
+        *stream = (weapon_texture_stream_t){.loading_level = -1};
+    }
+}
+
+// top level the textures of a weapon should have now
+int ctx_wanted_texture_level(ctx_t* ctx, int weapon_index,
+                             texture_cache_header_t const* header) {
+    int const initial_level =
+        texture_level_fitting(header, ctx->texture_streaming_initial_size);
+
+    if (weapon_index != ctx->selected_weapon)
+        return initial_level;
+
+    // pixels the weapon's bounding sphere spans on screen
+    float const scale = ctx->weapons.scales[weapon_index];
+    model_lods_t const* const lods = &ctx->weapons.lods[weapon_index];
+    float const covered_pixels =
+        2 * lods->radius * scale *
+        lods_pixels_per_unit(lods, ctx->camera, scalar_to_vec3(0), scale,
+                             ctx_screen_height());
+
+    int const level = texture_level_fitting(
+        header, (int)(covered_pixels * TEXTURE_STREAMING_TEXELS_PER_PIXEL));
+
+    // the levels loaded with the weapon are never dropped
+    return level < initial_level ? level : initial_level;
+}
+
+// swaps the texture for the levels read by the workers
+void ctx_finish_texture_stream(ctx_t* ctx, int weapon_index,
+                               weapon_texture_t texture_index) {
+    weapon_texture_stream_t* const stream =
+        &ctx->weapons.texture_streams[weapon_index][texture_index];
+    Texture2D* const texture =
+        &ctx->weapons.models[weapon_index]
+             .materials[0]
+             .maps[weapon_texture_material_map(texture_index)]
+             .texture;
+
+    Texture2D const levels = stream->pending.data != NULL
+                                 ? load_texture_levels(stream->pending)
+                                 : (Texture2D){0};
+    UnloadImage(stream->pending);
+    stream->pending = (Image){0};
+
+    if (levels.id == 0) {
+        // keeping the current levels, and not trying again
+        TraceLog(LOG_WARNING, "TEXSTREAM: [%s] Can't load level %d",
+                 ctx->weapons.descs[weapon_index].texture_paths[texture_index],
+                 stream->loading_level);
+        stream->header = (texture_cache_header_t){0};
+        stream->loading_level = -1;
+        return;
+    }
+
+    UnloadTexture(*texture);
+    *texture = levels;
+    stream->resident_level = stream->loading_level;
+    stream->loading_level = -1;
+
+    ctx->weapons.sizes[weapon_index] = ctx_weapon_memory_size(ctx, weapon_index);
+}
+
+void ctx_update_texture_stream(ctx_t* ctx, int weapon_index,
+                               weapon_texture_t texture_index) {
+    weapon_texture_stream_t* const stream =
+        &ctx->weapons.texture_streams[weapon_index][texture_index];
+
+    if (!is_texture_streamed(stream))
+        return;
+
+    if (stream->loading_level >= 0) {
+        if (jobs_is_done(&ctx->jobs, &stream->group))
+            ctx_finish_texture_stream(ctx, weapon_index, texture_index);
+
+        // one read per texture in flight
+        return;
+    }
+
+    int const wanted =
+        ctx_wanted_texture_level(ctx, weapon_index, &stream->header);
+
+    // finer levels as soon as they're wanted, coarser ones once they
+    // save at least 2 levels, so that small zooms don't thrash
+    if (wanted >= stream->resident_level && wanted <= stream->resident_level + 1)
+        return;
+
+    texture_levels_job_t* const job = malloc(sizeof(texture_levels_job_t));
+    *job = (texture_levels_job_t){
+        .path = ctx->weapons.descs[weapon_index].texture_paths[texture_index],
+        .max_size = texture_level_size(&stream->header, wanted),
+        .image = &stream->pending};
+
+    stream->loading_level = wanted;
+    stream->group = (job_group_t){0};
+    jobs_push(&ctx->jobs, read_texture_levels_job, job, &stream->group);
+}
+
+void ctx_update_texture_streaming(ctx_t* ctx) {
+    PROFILE_ZONE("ctx_update_texture_streaming");
+
+    if (!ctx->texture_streaming)
+        return;
+
+    for (int i = 0; i < ctx->weapons.count; i++) {
+        if (!ctx_is_weapon_resident(ctx, i))
+            continue;
+
+        for (int j = 0; j < WEAPON_TEXTURE_COUNT; j++)
+            ctx_update_texture_stream(ctx, i, j);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef SOURCE_TEXTURESTREAMING_C
+#define SOURCE_TEXTURESTREAMING_C
+
+#include "Context.h"
+
+// max_size the weapon textures are first loaded with
+// (0, every level, when texture streaming is off)
+int ctx_texture_streaming_initial_size(ctx_t* ctx);
+
+// tracks the levels a weapon just made resident came in with
+void ctx_start_weapon_texture_streams(ctx_t* ctx, int weapon_index);
+
+// waits for the in-flight reads of a weapon about to be
+// unloaded and drops them
+void ctx_stop_weapon_texture_streams(ctx_t* ctx, int weapon_index);
+
+// uploads the levels read by the workers and queues the reads of the
+// levels wanted now: finer ones while the selected weapon covers enough
+// pixels, coarser ones when it's zoomed out or deselected.
+// to call once per frame, after the weapon streaming
+void ctx_update_texture_streaming(ctx_t* ctx);
+
+#endif
@@ -0,0 +1,288 @@
+#include "Ui.h"
+#include <string.h>
+
+void unload_ui_mesh_cpu(Mesh mesh) {
+    RL_FREE(mesh.vertices);
+    RL_FREE(mesh.texcoords);
+    RL_FREE(mesh.colors);
+}
+
+void init_ui_cpu(ui_t* ui, Font font, text_cache_t* texts) {
+    *ui = (ui_t){.font = font, .texts = texts};
+
+    // the default material only references the default shader
+    ui->material = LoadMaterialDefault();
+}
+
+void init_ui(ui_t* ui, Font font, text_cache_t* texts) {
+    init_ui_cpu(ui, font, texts);
+    ui->material.shader = LoadShader(NULL, UI_SHADER_PATH);
+}
+
+void deinit_ui(ui_t* ui) {
+    if (ui->mesh.vaoId > 0)
+        UnloadMesh(ui->mesh);
+    else
+        unload_ui_mesh_cpu(ui->mesh);
+
+    UnloadShader(ui->material.shader);
+    // UnloadMaterial would unload the font as well
+    RL_FREE(ui->material.maps);
+    free(ui->widgets);
+}
+
+// grows the vertex buffer so that count more vertices fit,
+// the gpu copy is dropped and uploaded again by the next draw
+void ui_reserve_vertices(ui_t* ui, int count) {
+    int const needed = ui->vertex_count + count;
+    if (needed <= ui->vertex_capacity)
+        return;
+
+    int capacity = ui->vertex_capacity > 0 ? ui->vertex_capacity * 2 : 1024;
+    while (capacity < needed)
+        capacity *= 2;
+
+    Mesh grown = {0};
+    grown.vertices = RL_CALLOC(capacity * 3, sizeof(float));
+    grown.texcoords = RL_CALLOC(capacity * 2, sizeof(float));
+    grown.colors = RL_CALLOC(capacity * 4, sizeof(unsigned char));
+
+    if (ui->vertex_count > 0) {
+        memcpy(grown.vertices, ui->mesh.vertices,
+               ui->vertex_count * 3 * sizeof(float));
+        memcpy(grown.texcoords, ui->mesh.texcoords,
+               ui->vertex_count * 2 * sizeof(float));
+        memcpy(grown.colors, ui->mesh.colors,
+               ui->vertex_count * 4 * sizeof(unsigned char));
+    }
+
+    if (ui->mesh.vaoId > 0)
+        UnloadMesh(ui->mesh);
+    else
+        unload_ui_mesh_cpu(ui->mesh);
+
+    ui->mesh = grown;
+    ui->vertex_capacity = capacity;
+}
+
+int ui_add_widget(ui_t* ui, ui_widget_t widget) {
+    if (ui->count == ui->capacity) {
+        ui->capacity = ui->capacity > 0 ? ui->capacity * 2 : 32;
+        ui->widgets = realloc(ui->widgets, sizeof(ui_widget_t) * ui->capacity);
+    }
+
+    ui_reserve_vertices(ui, widget.vertex_capacity);
+    widget.first_vertex = ui->vertex_count;
+    widget.visible = true;
+    widget.dirty = true;
+    ui->vertex_count += widget.vertex_capacity;
+
+    ui->widgets[ui->count] = widget;
+    return ui->count++;
+}
+
+int ui_add_rect(ui_t* ui, Rectangle r, float thickness, Color color) {
+    return ui_add_widget(ui, (ui_widget_t){.kind = UI_WIDGET_RECT,
+                                           .rect = r,
+                                           .thickness = thickness,
+                                           .color = color,
+                                           .vertex_capacity = UI_RECT_VERTICES});
+}
+
+int ui_add_text(ui_t* ui, char const* text, Vector2 pos, float size,
+                float spacing, Color color) {
+    ui_widget_t widget = {.kind = UI_WIDGET_TEXT,
+                          .rect = rect(pos, vec2(0, 0)),
+                          .color = color,
+                          .size = size,
+                          .spacing = spacing,
+                          .vertex_capacity = UI_TEXT_VERTICES};
+    snprintf(widget.text, sizeof(widget.text), "%s", text);
+
+    return ui_add_widget(ui, widget);
+}
+
+void ui_set_rect(ui_t* ui, int id, Rectangle r) {
+    ui_widget_t* const widget = &ui->widgets[id];
+
+    if (memcmp(&widget->rect, &r, sizeof(r)) != 0) {
+        widget->rect = r;
+        widget->dirty = true;
+    }
+}
+
+void ui_set_position(ui_t* ui, int id, Vector2 pos) {
+    ui_widget_t const* const widget = &ui->widgets[id];
+    ui_set_rect(ui, id, rect(pos, vec2(widget->rect.width,
+                                       widget->rect.height)));
+}
+
+void ui_set_thickness(ui_t* ui, int id, float thickness) {
+    ui_widget_t* const widget = &ui->widgets[id];
+
+    if (widget->thickness != thickness) {
+        widget->thickness = thickness;
+        widget->dirty = true;
+    }
+}
+
+void ui_set_color(ui_t* ui, int id, Color color) {
+    ui_widget_t* const widget = &ui->widgets[id];
+
+    if (memcmp(&widget->color, &color, sizeof(color)) != 0) {
+        widget->color = color;
+        widget->dirty = true;
+    }
+}
+
+void ui_set_text(ui_t* ui, int id, char const* text) {
+    ui_widget_t* const widget = &ui->widgets[id];
+
+    if (strncmp(widget->text, text, sizeof(widget->text) - 1) != 0) {
+        snprintf(widget->text, sizeof(widget->text), "%s", text);
+        widget->dirty = true;
+    }
+}
+
+void ui_set_visible(ui_t* ui, int id, bool visible) {
+    ui_widget_t* const widget = &ui->widgets[id];
+
+    if (widget->visible != visible) {
+        widget->visible = visible;
+        widget->dirty = true;
+    }
+}
+
+Vector2 ui_text_size(ui_t* ui, int id) {
+    ui_widget_t const* const widget = &ui->widgets[id];
+    return text_cache_measure(ui->texts, ui->font, widget->text, widget->size,
+                              widget->spacing);
+}
+
+void ui_write_vertex(ui_t* ui, int v, Vector2 pos, Vector2 uv, Color color) {
+    ui->mesh.vertices[v * 3] = pos.x;
+    ui->mesh.vertices[v * 3 + 1] = pos.y;
+    ui->mesh.vertices[v * 3 + 2] = 0;
+    ui->mesh.texcoords[v * 2] = uv.x;
+    ui->mesh.texcoords[v * 2 + 1] = uv.y;
+    memcpy(&ui->mesh.colors[v * 4], &color, 4);
+}
+
+// a shape quad, as the rlgl ones: top left, bottom left,
+// bottom right, top right
+int ui_write_quad(ui_t* ui, int v, Rectangle r, Color color) {
+    Vector2 const corners[6] = {
+        vec2(r.x, r.y),           vec2(r.x, r.y + r.height),
+        vec2(r.x + r.width, r.y + r.height), vec2(r.x, r.y),
+        vec2(r.x + r.width, r.y + r.height), vec2(r.x + r.width, r.y)};
+
+    for (int i = 0; i < 6; i++)
+        ui_write_vertex(ui, v + i, corners[i], vec2(-1, -1), color);
+
+    return v + 6;
+}
+
+void ui_tessellate(ui_t* ui, ui_widget_t const* widget) {
+    int v = widget->first_vertex;
+
+    // the unused part of the range stays degenerate
+    memset(&ui->mesh.vertices[v * 3], 0,
+           widget->vertex_capacity * 3 * sizeof(float));
+
+    if (!widget->visible)
+        return;
+
+    if (widget->kind == UI_WIDGET_RECT) {
+        Rectangle const r = widget->rect;
+        float const t = widget->thickness;
+
+        if (t <= 0) {
+            ui_write_quad(ui, v, r, widget->color);
+            return;
+        }
+
+        // edges as DrawRectangleLinesEx lays them out
+        v = ui_write_quad(ui, v, rect(vec2(r.x, r.y), vec2(r.width, t)),
+                          widget->color);
+        v = ui_write_quad(ui, v,
+                          rect(vec2(r.x, r.y + r.height - t), vec2(r.width, t)),
+                          widget->color);
+        v = ui_write_quad(ui, v,
+                          rect(vec2(r.x, r.y + t), vec2(t, r.height - t * 2)),
+                          widget->color);
+        ui_write_quad(ui, v,
+                      rect(vec2(r.x + r.width - t, r.y + t),
+                           vec2(t, r.height - t * 2)),
+                      widget->color);
+        return;
+    }
+
+    // glyph quads of the cached layout, moved to the widget's position
+    text_layout_t const* const layout = text_cache_layout(
+        ui->texts, ui->font, widget->text, widget->size, widget->spacing);
+
+    for (int i = 0; i < layout->vertex_count; i++)
+        ui_write_vertex(ui, v + i,
+                        vec2(widget->rect.x + layout->positions[i].x,
+                             widget->rect.y + layout->positions[i].y),
+                        layout->texcoords[i], widget->color);
+}
+
+Mesh ui_cpu_mesh(ui_t* ui) {
+    for (int i = 0; i < ui->count; i++)
+        if (ui->widgets[i].dirty)
+            ui_tessellate(ui, &ui->widgets[i]);
+
+    Mesh mesh = ui->mesh;
+    mesh.vertexCount = ui->vertex_count;
+    mesh.triangleCount = ui->vertex_count / 3;
+
+    return mesh;
+}
+
+void ui_draw(ui_t* ui) {
+    if (ui->vertex_count == 0)
+        return;
+
+    bool const is_uploaded = ui->mesh.vaoId > 0;
+    ui->rebuilt_count = 0;
+
+    for (int i = 0; i < ui->count; i++) {
+        ui_widget_t* const widget = &ui->widgets[i];
+
+        if (!widget->dirty)
+            continue;
+
+        ui_tessellate(ui, widget);
+        widget->dirty = false;
+        ui->rebuilt_count++;
+
+        if (!is_uploaded)
+            continue;
+
+        // buffers 0, 1 and 3 of the mesh hold positions,
+        // texcoords and colors
+        int const first = widget->first_vertex;
+        int const count = widget->vertex_capacity;
+        UpdateMeshBuffer(ui->mesh, 0, &ui->mesh.vertices[first * 3],
+                         count * 3 * sizeof(float), first * 3 * sizeof(float));
+        UpdateMeshBuffer(ui->mesh, 1, &ui->mesh.texcoords[first * 2],
+                         count * 2 * sizeof(float), first * 2 * sizeof(float));
+        UpdateMeshBuffer(ui->mesh, 3, &ui->mesh.colors[first * 4], count * 4,
+                         first * 4);
+    }
+
+    // first draw or grown, the whole buffer goes up
+    if (!is_uploaded) {
+        ui->mesh.vertexCount = ui->vertex_capacity;
+        UploadMesh(&ui->mesh, true);
+    }
+
+    // the immediate mode draws queued before go first
+    rlDrawRenderBatchActive();
+
+    ui->mesh.vertexCount = ui->vertex_count;
+    ui->mesh.triangleCount = ui->vertex_count / 3;
+    ui->material.maps[MATERIAL_MAP_DIFFUSE].texture = ui->font.texture;
+    DrawMesh(ui->mesh, ui->material, MatrixIdentity());
+}
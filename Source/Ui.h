@@ -0,0 +1,88 @@
+#ifndef SOURCE_UI_C
+#define SOURCE_UI_C
+
+#include "Base.h"
+#include "RayLib.h"
+#include "TextCache.h"
+
+#define UI_SHADER_PATH ((char const*)"Res/Shaders/Ui.fs")
+// vertices reserved by a rectangle widget, 4 edges of 2 triangles
+#define UI_RECT_VERTICES ((int)24)
+// vertices reserved by a text widget, 2 triangles per glyph
+#define UI_TEXT_VERTICES ((int)(TEXT_LAYOUT_MAX_LENGTH * 6))
+
+typedef enum {
+    UI_WIDGET_RECT,
+    UI_WIDGET_TEXT
+} ui_widget_kind_t;
+
+// a widget declared once and kept, its vertices are
+// rebuilt only when one of its properties changes
+typedef struct {
+    ui_widget_kind_t kind;
+    // text widgets only use the position
+    Rectangle rect;
+    // rectangles only, 0 fills them
+    float thickness;
+    Color color;
+    char text[TEXT_LAYOUT_MAX_LENGTH];
+    float size;
+    float spacing;
+    bool visible;
+
+    // range of the widget in the shared vertex buffer
+    int first_vertex;
+    int vertex_capacity;
+    bool dirty;
+} ui_widget_t;
+
+// every widget is tessellated into one vertex buffer, drawn at once.
+// shapes and glyphs share it, the shapes having negative texcoords
+// (the ui shader gives them the plain vertex color)
+typedef struct {
+    ui_widget_t* widgets;
+    int count;
+    int capacity;
+
+    // cpu copy of the buffer, uploaded whole when it grew
+    // and by widget ranges otherwise
+    Mesh mesh;
+    int vertex_count;
+    int vertex_capacity;
+    Material material;
+
+    Font font;
+    text_cache_t* texts;
+    // widgets rebuilt by the last ui_draw
+    int rebuilt_count;
+} ui_t;
+
+void init_ui(ui_t* ui, Font font, text_cache_t* texts);
+// without the ui shader, for a ui only read through ui_cpu_mesh
+void init_ui_cpu(ui_t* ui, Font font, text_cache_t* texts);
+void deinit_ui(ui_t* ui);
+
+// declare a widget and return its id
+int ui_add_rect(ui_t* ui, Rectangle r, float thickness, Color color);
+int ui_add_text(ui_t* ui, char const* text, Vector2 pos, float size,
+                float spacing, Color color);
+
+// the setters only mark the widget dirty when the value changes
+void ui_set_rect(ui_t* ui, int id, Rectangle r);
+void ui_set_position(ui_t* ui, int id, Vector2 pos);
+void ui_set_thickness(ui_t* ui, int id, float thickness);
+void ui_set_color(ui_t* ui, int id, Color color);
+void ui_set_text(ui_t* ui, int id, char const* text);
+void ui_set_visible(ui_t* ui, int id, bool visible);
+
+// extents of a text widget's string
+Vector2 ui_text_size(ui_t* ui, int id);
+
+// rebuilds the dirty widgets and draws every widget in one draw call
+void ui_draw(ui_t* ui);
+
+// the vertices of every widget, the dirty ones rebuilt on the cpu
+// side only (they stay dirty, the next ui_draw uploads them)
+Mesh ui_cpu_mesh(ui_t* ui);
+
+#endif
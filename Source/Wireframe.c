@@ -0,0 +1,124 @@
+#include "Wireframe.h"
+#include "MeshCache.h"
+#include "Culling.h"
+#include <string.h>
+
+// barycentric coordinates of the triangle corners, as vertex colors
+static unsigned char const WIREFRAME_BARYCENTRICS[3][4] = {
+    {255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}};
+
+// one vertex per triangle corner, the shared ones can't
+// be welded since each corner gets its own barycentric
+Mesh barycentric_mesh(Mesh const* mesh) {
+    int const corner_count = mesh->triangleCount * 3;
+    Mesh expanded = {0};
+
+    if (corner_count <= 0 || mesh->vertexCount <= 0)
+        return expanded;
+
+    expanded.vertexCount = corner_count;
+    expanded.triangleCount = mesh->triangleCount;
+    expanded.vertices = RL_MALLOC(sizeof(float) * 3 * corner_count);
+    expanded.colors = RL_MALLOC(sizeof(unsigned char) * 4 * corner_count);
+    if (mesh->texcoords != NULL)
+        expanded.texcoords = RL_MALLOC(sizeof(float) * 2 * corner_count);
+
+    for (int i = 0; i < corner_count; i++) {
+        int const v = mesh->indices != NULL ? mesh->indices[i] : i;
+
+        memcpy(&expanded.vertices[i * 3], &mesh->vertices[v * 3],
+               sizeof(float) * 3);
+        memcpy(&expanded.colors[i * 4], WIREFRAME_BARYCENTRICS[i % 3], 4);
+        if (expanded.texcoords != NULL)
+            memcpy(&expanded.texcoords[i * 2], &mesh->texcoords[v * 2],
+                   sizeof(float) * 2);
+    }
+
+    return expanded;
+}
+
+model_wireframe_t generate_model_wireframe(Model const* model) {
+    int const mesh_count = model->meshCount;
+    model_wireframe_t wireframe = {0};
+
+    if (mesh_count <= 0)
+        return wireframe;
+
+    wireframe.mesh_count = mesh_count;
+    wireframe.meshes = RL_CALLOC(mesh_count, sizeof(Mesh));
+
+    for (int i = 0; i < mesh_count; i++)
+        wireframe.meshes[i] = barycentric_mesh(&model->meshes[i]);
+
+    return wireframe;
+}
+
+void upload_model_wireframe(model_wireframe_t* wireframe) {
+    for (int i = 0; i < wireframe->mesh_count; i++)
+        if (wireframe->meshes[i].vertexCount > 0)
+            UploadMesh(&wireframe->meshes[i], false);
+}
+
+void unload_model_wireframe(model_wireframe_t* wireframe) {
+    for (int i = 0; i < wireframe->mesh_count; i++)
+        UnloadMesh(wireframe->meshes[i]);
+
+    RL_FREE(wireframe->meshes);
+    *wireframe = (model_wireframe_t){0};
+}
+
+void unload_model_wireframe_cpu(model_wireframe_t* wireframe) {
+    for (int i = 0; i < wireframe->mesh_count; i++)
+        unload_mesh_cpu(wireframe->meshes[i]);
+
+    RL_FREE(wireframe->meshes);
+    *wireframe = (model_wireframe_t){0};
+}
+
+wireframe_shader_t load_wireframe_shader() {
+    wireframe_shader_t shader;
+    shader.shader =
+        LoadShader(WIREFRAME_SHADER_VS_PATH, WIREFRAME_SHADER_FS_PATH);
+    shader.wire_color_loc = GetShaderLocation(shader.shader, "wireColor");
+    shader.wire_width_loc = GetShaderLocation(shader.shader, "wireWidth");
+
+    float const width = WIREFRAME_LINE_WIDTH;
+    SetShaderValue(shader.shader, shader.wire_width_loc, &width,
+                   SHADER_UNIFORM_FLOAT);
+
+    return shader;
+}
+
+void unload_wireframe_shader(wireframe_shader_t shader) {
+    UnloadShader(shader.shader);
+}
+
+void draw_model_crossfade(Model model, model_wireframe_t const* wireframe,
+                          wireframe_shader_t const* shader,
+                          bool const* visible, Vector3 pos, float scale,
+                          Color solid, Color wire) {
+    Vector4 const wire_color = ColorNormalize(wire);
+    SetShaderValue(shader->shader, shader->wire_color_loc, &wire_color,
+                   SHADER_UNIFORM_VEC4);
+
+    Matrix const transform = model_draw_transform(model, pos, scale);
+
+    for (int i = 0; i < wireframe->mesh_count; i++) {
+        if (wireframe->meshes[i].vertexCount == 0 ||
+            (visible != NULL && !visible[i]))
+            continue;
+
+        Material material = model.materials[model.meshMaterial[i]];
+        material.shader = shader->shader;
+
+        // the maps are shared with the model, the tint
+        // is applied for this draw only (as DrawModel does)
+        Color const diffuse = material.maps[MATERIAL_MAP_DIFFUSE].color;
+        material.maps[MATERIAL_MAP_DIFFUSE].color =
+            color(diffuse.r * solid.r / 255, diffuse.g * solid.g / 255,
+                  diffuse.b * solid.b / 255, diffuse.a * solid.a / 255);
+
+        DrawMesh(wireframe->meshes[i], material, transform);
+        material.maps[MATERIAL_MAP_DIFFUSE].color = diffuse;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef SOURCE_WIREFRAME_C
+#define SOURCE_WIREFRAME_C
+
+#include "Base.h"
+#include "RayLib.h"
+
+#define WIREFRAME_SHADER_VS_PATH ((char const*)"Res/Shaders/Wireframe.vs")
+#define WIREFRAME_SHADER_FS_PATH ((char const*)"Res/Shaders/Wireframe.fs")
+// width of the edges in pixels
+#define WIREFRAME_LINE_WIDTH ((float)1)
+
+// unindexed copies of a model's meshes whose vertex colors hold
+// the barycentric coordinates of each triangle corner, so that the
+// edges can be found by the fragment shader
+typedef struct {
+    int mesh_count;
+    Mesh* meshes;
+} model_wireframe_t;
+
+// the crossfade shader and its uniforms
+typedef struct {
+    Shader shader;
+    int wire_color_loc;
+    int wire_width_loc;
+} wireframe_shader_t;
+
+// builds the barycentric meshes of the model (cpu side only,
+// safe to call from worker threads)
+model_wireframe_t generate_model_wireframe(Model const* model);
+void upload_model_wireframe(model_wireframe_t* wireframe);
+void unload_model_wireframe(model_wireframe_t* wireframe);
+// frees a wireframe generated but never uploaded
+void unload_model_wireframe_cpu(model_wireframe_t* wireframe);
+
+wireframe_shader_t load_wireframe_shader();
+void unload_wireframe_shader(wireframe_shader_t shader);
+
+// draws the model tinted by solid with its edges blended over in wire,
+// in a single pass (what DrawModel + DrawModelWires would look like).
+// the meshes not flagged visible are skipped (null draws every mesh)
+void draw_model_crossfade(Model model, model_wireframe_t const* wireframe,
+                          wireframe_shader_t const* shader,
+                          bool const* visible, Vector3 pos, float scale,
+                          Color solid, Color wire);
+
+#endif
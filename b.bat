@@ -1,3 +1,4 @@
 @if not exist "Build" mkdir "Build"
-@gcc "Source\Main.c" "Source\Context.c" "Source\Game.c" "Libs\RayLib\Lib\Lib.a" -o "Build\Demo.exe" -O3 -std=c99 -Wall -Wextra -Werror -lwinmm -lgdi32
-@rem -O3 -g
\ No newline at end of file
+@gcc "Source\Main.c" "Source\Context.c" "Source\Game.c" "Source\MeshCache.c" "Source\Jobs.c" "Source\Loader.c" "Source\Streaming.c" "Source\Catalogue.c" "Source\Bench.c" "Source\Profiler.c" "Source\StartupReport.c" "Source\MeshOpt.c" "Source\Lod.c" "Source\Culling.c" "Source\Bvh.c" "Source\Wireframe.c" "Source\PostFx.c" "Source\TextureCache.c" "Source\TextureStreaming.c" "Source\TextCache.c" "Source\FontCache.c" "Source\FramePacing.c" "Source\SoftRaster.c" "Source\SoftFrame.c" "Source\Golden.c" "Source\Headless.c" "Source\Ui.c" "Libs\RayLib\Lib\Lib.a" -o "Build\Demo.exe" -O3 -std=c99 -Wall -Wextra -Werror -lwinmm -lgdi32 -lpthread
+@rem -O3 -g
+@rem headless runs without a window system (egl): -DHEADLESS_EGL=1 -lEGL
\ No newline at end of file